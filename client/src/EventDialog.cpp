@@ -6,6 +6,7 @@
 #include <QTextEdit>
 #include <QDateTimeEdit>
 #include <QSpinBox>
+#include <QComboBox>
 #include <QPushButton>
 #include <QLabel>
 #include <QMessageBox>
@@ -58,6 +59,19 @@ void EventDialog::setupUI()
     m_reminderMinutesEdit->setSuffix(" minutes before");
     m_reminderMinutesEdit->setValue(60);
     
+    // Item data is the Recurrence::Frequency
+    m_repeatEdit = new QComboBox();
+    m_repeatEdit->addItem("Does not repeat", Recurrence::None);
+    m_repeatEdit->addItem("Daily", Recurrence::Daily);
+    m_repeatEdit->addItem("Weekly", Recurrence::Weekly);
+    m_repeatEdit->addItem("Monthly", Recurrence::Monthly);
+    
+    m_repeatCountEdit = new QSpinBox();
+    m_repeatCountEdit->setRange(0, 1000);
+    m_repeatCountEdit->setSpecialValueText("Forever"); // 0 = no count limit
+    m_repeatCountEdit->setSuffix(" times");
+    m_repeatCountEdit->setEnabled(false);
+    
     m_creatorEdit = new QLineEdit();
     m_creatorEdit->setPlaceholderText("Your name...");
 
@@ -66,6 +80,8 @@ void EventDialog::setupUI()
     formLayout->addRow("Description:", m_descriptionEdit);
     formLayout->addRow("Event Time*:", m_eventTimeEdit);
     formLayout->addRow("Reminder:", m_reminderMinutesEdit);
+    formLayout->addRow("Repeat:", m_repeatEdit);
+    formLayout->addRow("Occurrences:", m_repeatCountEdit);
     formLayout->addRow("Creator:", m_creatorEdit);
 
     // Create buttons
@@ -86,6 +102,9 @@ void EventDialog::setupUI()
     // Connect signals
     connect(m_titleEdit, &QLineEdit::textChanged, this, &EventDialog::validateInput);
     connect(m_eventTimeEdit, &QDateTimeEdit::dateTimeChanged, this, &EventDialog::validateInput);
+    connect(m_repeatEdit, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        m_repeatCountEdit->setEnabled(m_repeatEdit->currentData().toInt() != Recurrence::None);
+    });
     connect(m_okButton, &QPushButton::clicked, this, &EventDialog::onAccept);
     connect(m_cancelButton, &QPushButton::clicked, this, &EventDialog::onCancel);
 
@@ -108,6 +127,9 @@ void EventDialog::populateFields(const Event& event)
     auto reminderDuration = std::chrono::duration_cast<std::chrono::minutes>(
         event.event_time - event.reminder_time);
     m_reminderMinutesEdit->setValue(static_cast<int>(reminderDuration.count()));
+    
+    m_repeatEdit->setCurrentIndex(m_repeatEdit->findData(event.recurrence.frequency));
+    m_repeatCountEdit->setValue(event.recurrence.count);
 }
 
 Event EventDialog::getEvent() const
@@ -131,6 +153,16 @@ Event EventDialog::getEvent() const
     int reminderMinutes = m_reminderMinutesEdit->value();
     event.reminder_time = event.event_time - std::chrono::minutes(reminderMinutes);
     
+    // Interval, until and exceptions aren't editable here; an edited event
+    // keeps them (and the server's last_reminded) unless repeat is turned off
+    auto frequency = static_cast<Recurrence::Frequency>(m_repeatEdit->currentData().toInt());
+    if (frequency == Recurrence::None) {
+        event.recurrence = Recurrence();
+    } else {
+        event.recurrence.frequency = frequency;
+        event.recurrence.count = m_repeatCountEdit->value();
+    }
+    
     return event;
 }
 
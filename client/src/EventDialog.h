@@ -9,6 +9,7 @@ class QLineEdit;
 class QTextEdit;
 class QDateTimeEdit;
 class QSpinBox;
+class QComboBox;
 class QPushButton;
 class QVBoxLayout;
 class QHBoxLayout;
@@ -41,6 +42,8 @@ private:
     QTextEdit* m_descriptionEdit;
     QDateTimeEdit* m_eventTimeEdit;
     QSpinBox* m_reminderMinutesEdit;
+    QComboBox* m_repeatEdit;
+    QSpinBox* m_repeatCountEdit;
     QLineEdit* m_creatorEdit;
     QPushButton* m_okButton;
     QPushButton* m_cancelButton;
@@ -1,6 +1,8 @@
 #include "EventModel.h"
 #include <QDateTime>
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 EventModel::EventModel(QObject *parent)
     : QAbstractTableModel(parent)
@@ -33,6 +35,12 @@ QVariant EventModel::data(const QModelIndex &index, int role) const
         case DescriptionColumn:
             return QString::fromStdString(event.description);
         case EventTimeColumn:
+            if (event.recurrence.is_recurring()) {
+                // First occurrence plus the rule, e.g. "... (weekly)"
+                return QString("%1 (%2)")
+                        .arg(QString::fromStdString(event.get_formatted_time()))
+                        .arg(Recurrence::frequency_name(event.recurrence.frequency));
+            }
             return QString::fromStdString(event.get_formatted_time());
         case CreatorColumn:
             return QString::fromStdString(event.creator);
@@ -140,6 +148,50 @@ void EventModel::removeEvent(int eventId)
     }
 }
 
+void EventModel::applyBatch(const std::vector<EventOperation>& operations)
+{
+    if (operations.empty())
+        return;
+
+    // Last operation per id wins, as it did on the server
+    std::unordered_map<int, const Event*> upserts;
+    std::unordered_set<int> deletions;
+    for (const auto& operation : operations) {
+        if (operation.type == EventOperation::Delete) {
+            upserts.erase(operation.event_id);
+            deletions.insert(operation.event_id);
+        } else {
+            deletions.erase(operation.event.id);
+            upserts[operation.event.id] = &operation.event;
+        }
+    }
+
+    beginResetModel();
+    std::vector<Event> events;
+    events.reserve(m_events.size() + upserts.size());
+    for (const auto& event : m_events) {
+        if (deletions.count(event.id))
+            continue;
+        auto it = upserts.find(event.id);
+        if (it != upserts.end()) {
+            events.push_back(*it->second);
+            upserts.erase(it);
+        } else {
+            events.push_back(event);
+        }
+    }
+    // Whatever is left was not in the model yet
+    for (const auto& entry : upserts) {
+        events.push_back(*entry.second);
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event& a, const Event& b) {
+                         return a.event_time < b.event_time;
+                     });
+    m_events = std::move(events);
+    endResetModel();
+}
+
 Event EventModel::getEvent(int row) const
 {
     if (row >= 0 && row < static_cast<int>(m_events.size())) {
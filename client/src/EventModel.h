@@ -4,6 +4,7 @@
 #include <QAbstractTableModel>
 #include <vector>
 #include "Event.h"
+#include "EventBatch.h"
 
 class EventModel : public QAbstractTableModel
 {
@@ -31,6 +32,8 @@ public:
     void addEvent(const Event& event);
     void updateEvent(const Event& event);
     void removeEvent(int eventId);
+    // Applies a whole committed batch with a single model reset
+    void applyBatch(const std::vector<EventOperation>& operations);
     Event getEvent(int row) const;
     void clear();
 
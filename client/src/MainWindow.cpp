@@ -45,8 +45,14 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onEventReceived);
     connect(m_client.get(), &WebSocketClient::eventListReceived,
             this, &MainWindow::onEventListReceived);
+    connect(m_client.get(), &WebSocketClient::eventBatchReceived,
+            this, &MainWindow::onEventBatchReceived);
+    connect(m_client.get(), &WebSocketClient::eventWriteFailed,
+            this, &MainWindow::onEventWriteFailed);
     connect(m_client.get(), &WebSocketClient::reminderReceived,
             this, &MainWindow::onReminderReceived);
+    connect(m_client.get(), &WebSocketClient::reminderBatchReceived,
+            this, &MainWindow::onReminderBatchReceived);
     connect(m_client.get(), &WebSocketClient::errorOccurred,
             this, &MainWindow::onConnectionError);
     
@@ -216,10 +222,33 @@ void MainWindow::onEventListReceived(const std::vector<Event>& events) {
     m_eventModel->setEvents(events);
 }
 
+void MainWindow::onEventBatchReceived(const std::vector<EventOperation>& operations) {
+    m_eventModel->applyBatch(operations);
+}
+
+void MainWindow::onEventWriteFailed(const QString& error) {
+    QMessageBox::warning(this, "Change Not Saved", error);
+}
+
 void MainWindow::onReminderReceived(const Event& event, const QString& message) {
     showReminder(QString::fromStdString(event.title), message);
 }
 
+// A batch is one notification, listing the first few events
+void MainWindow::onReminderBatchReceived(const std::vector<Event>& events, const QStringList& messages) {
+    if (events.size() == 1) {
+        showReminder(QString::fromStdString(events.front().title), messages.value(0));
+        return;
+    }
+    
+    const int kListed = 5;
+    QStringList lines = messages.mid(0, kListed);
+    if (messages.size() > kListed) {
+        lines << QString("...and %1 more").arg(messages.size() - kListed);
+    }
+    showReminder(QString("%1 events starting soon").arg(events.size()), lines.join("\n"));
+}
+
 void MainWindow::onConnectionError(const QString& error) {
     QMessageBox::warning(this, "Connection Error", error);
     m_isConnected = false;
@@ -311,6 +340,22 @@ void MainWindow::onDeleteEventClicked() {
         return;
     }
     
+    if (selection.size() > 1) {
+        // Several rows: one event_batch, one transaction, one broadcast
+        int ret = QMessageBox::question(this, "Confirm Delete",
+                                      QString("Are you sure you want to delete %1 events?")
+                                      .arg(selection.size()));
+        if (ret == QMessageBox::Yes) {
+            std::vector<EventOperation> operations;
+            for (const QModelIndex& index : selection) {
+                Event selected = m_eventModel->getEvent(index.row());
+                operations.push_back(EventOperation::remove(selected.id, selected.version));
+            }
+            m_client->sendEventBatch(operations);
+        }
+        return;
+    }
+    
     int row = selection.first().row();
     Event event = m_eventModel->getEvent(row);
     
@@ -319,7 +364,7 @@ void MainWindow::onDeleteEventClicked() {
                                   .arg(QString::fromStdString(event.title)));
     
     if (ret == QMessageBox::Yes) {
-        m_client->deleteEvent(event.id);
+        m_client->deleteEvent(event.id, event.version);
     }
 }
 
@@ -34,7 +34,10 @@ private slots:
     void onDisconnectedFromServer();
     void onEventReceived(const Event& event, const QString& action);
     void onEventListReceived(const std::vector<Event>& events);
+    void onEventBatchReceived(const std::vector<EventOperation>& operations);
+    void onEventWriteFailed(const QString& error);
     void onReminderReceived(const Event& event, const QString& message);
+    void onReminderBatchReceived(const std::vector<Event>& events, const QStringList& messages);
     void onConnectionError(const QString& error);
     
     // Authentication slots
@@ -66,16 +66,27 @@ void WebSocketClient::updateEvent(const Event& event) {
     sendMessage(QString::fromStdString(Protocol::EVENT_UPDATE), json_data);
 }
 
-void WebSocketClient::deleteEvent(int eventId) {
+void WebSocketClient::deleteEvent(int eventId, int version) {
     if (!m_isConnected || !m_isAuthenticated) return;
     
     nlohmann::json data = {
         {"id", eventId},
+        {"version", version},
         {"auth_token", m_authToken.toStdString()}
     };
     sendMessage(QString::fromStdString(Protocol::EVENT_DELETE), data);
 }
 
+void WebSocketClient::sendEventBatch(const std::vector<EventOperation>& operations) {
+    if (!m_isConnected || !m_isAuthenticated || operations.empty()) return;
+    
+    nlohmann::json data = {
+        {"operations", EventBatch::to_json(operations)},
+        {"auth_token", m_authToken.toStdString()}
+    };
+    sendMessage(QString::fromStdString(Protocol::EVENT_BATCH), data);
+}
+
 void WebSocketClient::requestEventList() {
     if (!m_isConnected || !m_isAuthenticated) return;
     
@@ -142,7 +153,11 @@ void WebSocketClient::onDisconnected() {
 
 void WebSocketClient::onTextMessageReceived(const QString& message) {
     try {
-        auto [type, data] = Protocol::parse_message(message.toStdString());
+        std::string text = message.toStdString();
+        if (MessageDecoder::decode(text, m_decoded) && handleDecodedMessage(m_decoded)) {
+            return;
+        }
+        auto [type, data] = Protocol::parse_message(text);
         handleMessage(QString::fromStdString(type), data);
     } catch (const std::exception& e) {
         qDebug() << "Error parsing message:" << e.what();
@@ -150,6 +165,35 @@ void WebSocketClient::onTextMessageReceived(const QString& message) {
     }
 }
 
+bool WebSocketClient::handleDecodedMessage(const DecodedMessage& message) {
+    const std::string& type = message.type;
+    if (type == Protocol::EVENT_LIST) {
+        emit eventListReceived(message.events);
+        
+    } else if (type == Protocol::EVENT_UPDATE) {
+        if (message.events.size() != 1) return false;
+        emit eventReceived(message.events.front(), QString::fromStdString(message.action));
+        
+    } else if (type == Protocol::REMINDER || type == Protocol::REMINDER_BATCH) {
+        if (message.events.empty()) return false;
+        QStringList messages;
+        for (size_t i = 0; i < message.events.size(); ++i) {
+            messages << (message.messages[i].empty()
+                ? QString("Reminder: %1 is starting soon!").arg(QString::fromStdString(message.events[i].title))
+                : QString::fromStdString(message.messages[i]));
+        }
+        if (type == Protocol::REMINDER) {
+            emit reminderReceived(message.events.front(), messages.front());
+        } else {
+            emit reminderBatchReceived(message.events, messages);
+        }
+        
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void WebSocketClient::onError(QAbstractSocket::SocketError error) {
     QString errorString;
     switch (error) {
@@ -292,6 +336,37 @@ void WebSocketClient::handleMessage(const QString& type, const nlohmann::json& d
             event.id = data["id"];
             emit eventReceived(event, "deleted");
             
+        } else if (type == QString::fromStdString(Protocol::EVENT_BATCH)) {
+            if (data.contains("operations")) {
+                // Committed batch broadcast to every session
+                std::vector<EventOperation> operations;
+                for (const auto& item : data["operations"]) {
+                    EventOperation operation;
+                    std::string error;
+                    if (EventOperation::from_json(item, operation, error)) {
+                        operations.push_back(operation);
+                    }
+                }
+                emit eventBatchReceived(operations);
+            } else if (!data.value("committed", false)) {
+                // Our own batch was rejected or rolled back
+                QString error = QString::fromStdString(data.value("error", std::string("Batch failed")));
+                for (const auto& result : data.value("results", nlohmann::json::array())) {
+                    if (result.contains("error")) {
+                        error += QString("\n#%1: %2").arg(result["index"].get<int>())
+                                     .arg(QString::fromStdString(result["error"]));
+                    }
+                }
+                emit eventWriteFailed(error);
+            }
+            
+        } else if (type == QString::fromStdString(Protocol::EVENT_ERROR)) {
+            // On a version conflict the server sends its current copy
+            if (data.contains("event")) {
+                emit eventReceived(Event::from_json(data["event"]), "updated");
+            }
+            emit eventWriteFailed(QString::fromStdString(data.value("error", std::string("Event change failed"))));
+            
         } else if (type == QString::fromStdString(Protocol::REMINDER)) {
             qDebug() << "🔔 CLIENT: Processing REMINDER message";
             
@@ -311,6 +386,18 @@ void WebSocketClient::handleMessage(const QString& type, const nlohmann::json& d
             
             emit reminderReceived(event, message);
             
+        } else if (type == QString::fromStdString(Protocol::REMINDER_BATCH)) {
+            std::vector<Event> events;
+            QStringList messages;
+            for (const auto& item : data.value("reminders", nlohmann::json::array())) {
+                events.push_back(Event::from_json(item));
+                messages << QString::fromStdString(item.value("message",
+                    "Reminder: " + events.back().title + " is starting soon!"));
+            }
+            if (!events.empty()) {
+                emit reminderBatchReceived(events, messages);
+            }
+            
         } else if (type == QString::fromStdString(Protocol::HEARTBEAT)) {
             // Heartbeat response - no action needed
             qDebug() << "CLIENT: Heartbeat received";
@@ -4,8 +4,11 @@
 #include <QObject>
 #include <QWebSocket>
 #include <QTimer>
+#include <QStringList>
 #include <memory>
 #include "Event.h"
+#include "EventBatch.h"
+#include "MessageDecoder.h"
 
 class WebSocketClient : public QObject
 {
@@ -22,7 +25,8 @@ public:
     // Event operations
     void createEvent(const Event& event);
     void updateEvent(const Event& event);
-    void deleteEvent(int eventId);
+    void deleteEvent(int eventId, int version = 0);
+    void sendEventBatch(const std::vector<EventOperation>& operations);
     void requestEventList();
     
     // Authentication operations
@@ -36,7 +40,13 @@ signals:
     void disconnected();
     void eventReceived(const Event& event, const QString& action);
     void eventListReceived(const std::vector<Event>& events);
+    void eventBatchReceived(const std::vector<EventOperation>& operations);
+    // A create/update/delete or batch of ours was refused (conflict,
+    // permission, rollback); not a connection problem
+    void eventWriteFailed(const QString& error);
     void reminderReceived(const Event& event, const QString& message);
+    // Reminders the server coalesced into one frame (same due tick)
+    void reminderBatchReceived(const std::vector<Event>& events, const QStringList& messages);
     void errorOccurred(const QString& error);
     
     // Authentication signals
@@ -56,11 +66,15 @@ private slots:
 private:
     void sendMessage(const QString& type, const nlohmann::json& data = {});
     void handleMessage(const QString& type, const nlohmann::json& data);
+    // Event lists, updates and reminders straight from MessageDecoder;
+    // false for anything handleMessage has to see
+    bool handleDecodedMessage(const DecodedMessage& message);
 
     std::unique_ptr<QWebSocket> m_webSocket;
     QTimer* m_heartbeatTimer;
     QString m_serverUrl;
     bool m_isConnected;
+    DecodedMessage m_decoded;   // reused between messages
     
     // Authentication state
     QString m_authToken;
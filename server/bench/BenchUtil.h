@@ -0,0 +1,123 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Helpers shared by the benchmarks in this directory: a stopwatch, database
+// file cleanup and generated events, plain or with text the JSON code has
+// to escape.
+
+#include "Database.h"
+#include "Event.h"
+#include <sqlite3.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double elapsed_s() const { return elapsed<std::ratio<1>>(); }
+    double elapsed_ms() const { return elapsed<std::milli>(); }
+    double elapsed_us() const { return elapsed<std::micro>(); }
+    double elapsed_ns() const { return elapsed<std::nano>(); }
+
+    template <typename Period>
+    double elapsed() const {
+        return std::chrono::duration<double, Period>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// The database file and whatever SQLite kept beside it
+inline void remove_database(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    std::remove((path + "-journal").c_str());
+}
+
+inline int64_t epoch_ms(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+// Event i of a generated table: one a minute from `base`, owned in turn by
+// users 1..users, reminded an hour ahead
+inline Event make_event(int i, std::chrono::system_clock::time_point base, int users = 100) {
+    Event event(1 + i % users, "Event " + std::to_string(i), "Generated by a benchmark",
+                base + std::chrono::minutes(i), "bench");
+    event.created_at = base;
+    return event;
+}
+
+// Event i with what the escaper has to deal with in its title: quotes,
+// backslashes, control characters and multi-byte UTF-8. Every tenth one
+// repeats weekly, with an exception.
+inline Event text_event(int i, std::chrono::system_clock::time_point base) {
+    const char* const kTitles[] = {
+        "Quarterly planning", "Design review \"v2\"", "Caf\xc3\xa9 meetup", "Build C:\\tmp\\out",
+        "Line one\nline two", "Tab\tseparated \x01\x1f\x7f", "\xe4\xbc\x9a\xe8\xad\xb0 standup", "Deploy \xf0\x9f\x9a\x80",
+    };
+    base = std::chrono::time_point_cast<std::chrono::milliseconds>(base);
+    Event event(1 + i % 100, kTitles[i % 8], "Agenda item " + std::to_string(i) + " for the weekly sync",
+                base + std::chrono::minutes(i), "user" + std::to_string(i % 100));
+    event.id = i + 1;
+    event.version = 1 + i % 3;
+    event.created_at = base;
+    if (i % 10 == 0) {
+        event.recurrence.frequency = Recurrence::Weekly;
+        event.recurrence.count = 10;
+        event.recurrence.exceptions.push_back(event.event_time + std::chrono::hours(24 * 7));
+    }
+    return event;
+}
+
+// Creates the schema at `path` and bulk loads make(0) .. make(events - 1)
+// through a plain connection, in large transactions without syncing, so
+// every run starts from the same table
+template <typename MakeEvent>
+bool populate(const std::string& path, int events, MakeEvent make) {
+    {
+        DatabaseOptions options = DatabaseOptions::for_profile(DatabaseProfile::Throughput);
+        options.cache_events = false;
+        Database schema(path, options);
+    }
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+        sqlite3_close(db);
+        return false;
+    }
+    sqlite3_exec(db, "PRAGMA synchronous=OFF;", nullptr, nullptr, nullptr);
+
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db,
+        "INSERT INTO events (user_id, title, description, event_time, reminder_time, creator, reminder_sent, created_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, 0, ?);", -1, &stmt, nullptr);
+
+    const int batch = 10000;
+    for (int i = 0; i < events; ++i) {
+        if (i % batch == 0) sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+        Event event = make(i);
+        sqlite3_bind_int(stmt, 1, event.user_id);
+        sqlite3_bind_text(stmt, 2, event.title.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, event.description.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 4, epoch_ms(event.event_time));
+        sqlite3_bind_int64(stmt, 5, epoch_ms(event.reminder_time));
+        sqlite3_bind_text(stmt, 6, event.creator.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 7, epoch_ms(event.created_at));
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (i % batch == batch - 1 || i == events - 1) sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return true;
+}
+
+// populate() with make_event()
+inline bool populate(const std::string& path, int events, int users = 100) {
+    auto base = std::chrono::system_clock::now();
+    return populate(path, events, [&](int i) { return make_event(i, base, users); });
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,112 @@
+// Per-operation cost of the Database CRUD path (create / get / update /
+// delete) followed by the per-statement counters collected by Database.
+// The "read+update" and "owned update" rows compare the old client edit
+// path (ownership read, then UPDATE) with the single conditional statement.
+//
+// Usage: crud_bench [operations] [db_path]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+void report(const char* label, double total_us, int operations) {
+    std::printf("%-12s %8.2f us/op  (%d ops)\n", label, total_us / operations, operations);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int operations = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::string db_path = argc > 2 ? argv[2] : ":memory:";
+
+    Database database(db_path);
+    auto now = std::chrono::system_clock::now();
+
+    int first_id = 0;
+    {
+        Timer timer;
+        for (int i = 0; i < operations; ++i) {
+            Event event(1 + i % 50, "Event " + std::to_string(i), "Benchmark event",
+                        now + std::chrono::minutes(i), "bench");
+            int id = database.create_event(event);
+            if (i == 0) first_id = id;
+        }
+        report("create", timer.elapsed_us(), operations);
+    }
+
+    {
+        Timer timer;
+        size_t found = 0;
+        for (int i = 0; i < operations; ++i) {
+            found += database.get_event_by_id(first_id + i).id != 0;
+        }
+        report("get_by_id", timer.elapsed_us(), operations);
+        if (found != static_cast<size_t>(operations)) {
+            std::fprintf(stderr, "expected %d events, found %zu\n", operations, found);
+        }
+    }
+
+    {
+        Timer timer;
+        for (int i = 0; i < operations; ++i) {
+            Event event(1 + i % 50, "Updated " + std::to_string(i), "Benchmark event",
+                        now + std::chrono::minutes(i), "bench");
+            event.id = first_id + i;
+            database.update_event(event);
+        }
+        report("update", timer.elapsed_us(), operations);
+    }
+
+    {
+        Timer timer;
+        for (int i = 0; i < operations; ++i) {
+            Event event(1 + i % 50, "Checked " + std::to_string(i), "Benchmark event",
+                        now + std::chrono::minutes(i), "bench");
+            event.id = first_id + i;
+            if (database.get_event_by_id(event.id).user_id == event.user_id) {
+                database.update_event(event);
+            }
+        }
+        report("read+update", timer.elapsed_us(), operations);
+    }
+
+    {
+        Timer timer;
+        for (int i = 0; i < operations; ++i) {
+            Event event(1 + i % 50, "Owned " + std::to_string(i), "Benchmark event",
+                        now + std::chrono::minutes(i), "bench");
+            event.id = first_id + i;
+            database.update_owned_event(event, event.user_id);
+        }
+        report("owned update", timer.elapsed_us(), operations);
+    }
+
+    {
+        // Same content again: matched by the no-op check, nothing written
+        Timer timer;
+        for (int i = 0; i < operations; ++i) {
+            Event event(1 + i % 50, "Owned " + std::to_string(i), "Benchmark event",
+                        now + std::chrono::minutes(i), "bench");
+            event.id = first_id + i;
+            database.update_owned_event(event, event.user_id);
+        }
+        report("no-op update", timer.elapsed_us(), operations);
+    }
+
+    {
+        Timer timer;
+        for (int i = 0; i < operations; ++i) {
+            database.delete_owned_event(first_id + i, 1 + i % 50, 0);
+        }
+        report("owned delete", timer.elapsed_us(), operations);
+    }
+
+    std::printf("\nstatement statistics:\n");
+    database.log_statement_stats();
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Write and read throughput of each DatabaseProfile on a pre-populated
+// events table.
+//
+// Usage: db_profile_bench [events=1000000] [writes=2000] [reads=100000] [dir=.]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace {
+
+// SQLite defaults as used before profiles existed: rollback journal, synchronous=FULL
+DatabaseOptions legacy_options() {
+    DatabaseOptions options = DatabaseOptions::for_profile(DatabaseProfile::Durable);
+    options.journal_mode = "DELETE";
+    options.cache_size_kib = 2000;
+    options.temp_store = "DEFAULT";
+    options.checkpoint_interval = std::chrono::seconds(0);
+    return options;
+}
+
+void run_profile(const std::string& label, const DatabaseOptions& options, const std::string& dir,
+                 int events, int writes, int reads) {
+    std::string path = dir + "/profile_bench_" + label + ".db";
+    remove_database(path);
+
+    Timer load_timer;
+    populate(path, events);
+    double load_s = load_timer.elapsed_s();
+
+    // Reads must reach SQLite to compare the profiles
+    DatabaseOptions sqlite_options = options;
+    sqlite_options.cache_events = false;
+    Database database(path, sqlite_options);
+    auto now = std::chrono::system_clock::now();
+
+    // Autocommit writes: one transaction (and sync) per create_event
+    Timer write_timer;
+    for (int i = 0; i < writes; ++i) {
+        Event event(1 + i % 100, "Write " + std::to_string(i), "profile bench write",
+                    now + std::chrono::minutes(i), "bench");
+        database.create_event(event);
+    }
+    double write_s = write_timer.elapsed_s();
+
+    // Point reads by primary key
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(1, events);
+    Timer read_timer;
+    size_t found = 0;
+    for (int i = 0; i < reads; ++i) {
+        found += database.get_event_by_id(pick(rng)).id != 0;
+    }
+    double read_s = read_timer.elapsed_s();
+
+    // Range read: one user's events ordered by time
+    Timer scan_timer;
+    size_t scanned = database.get_events_for_user(7).size();
+    double scan_s = scan_timer.elapsed_s();
+
+    std::printf("%-10s load %7.2fs | writes %9.0f/s | point reads %9.0f/s (%zu hits) | user scan %6.1f ms (%zu rows)\n",
+                label.c_str(), load_s, writes / write_s, reads / read_s, found,
+                scan_s * 1000.0, scanned);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int events = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int writes = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int reads = argc > 3 ? std::atoi(argv[3]) : 100000;
+    std::string dir = argc > 4 ? argv[4] : ".";
+
+    std::printf("events: %d, autocommit writes: %d, point reads: %d\n", events, writes, reads);
+    run_profile("legacy", legacy_options(), dir, events, writes, reads);
+    for (DatabaseProfile profile : {DatabaseProfile::Durable, DatabaseProfile::Balanced,
+                                    DatabaseProfile::Throughput}) {
+        run_profile(DatabaseOptions::profile_name(profile), DatabaseOptions::for_profile(profile),
+                    dir, events, writes, reads);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Parse throughput on large event_list messages: Protocol::parse_message
+// plus Event::from_json per element (the DOM path) against
+// MessageDecoder's single SAX pass. Checks both produce the same events
+// before timing them.
+//
+// Usage: decode_bench [events=100000] [rounds=5]
+
+#include "BenchUtil.h"
+#include "Event.h"
+#include "JsonWriter.h"
+#include "MessageDecoder.h"
+#include "Protocol.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string make_message(int count) {
+    auto base = std::chrono::system_clock::now();
+    std::string out;
+    Protocol::write_message(out, Protocol::EVENT_LIST, [&](JsonWriter& writer) {
+        writer.begin_array();
+        for (int i = 0; i < count; ++i) {
+            text_event(i, base).write_json(writer);
+        }
+        writer.end_array();
+    });
+    return out;
+}
+
+std::vector<Event> dom_decode(const std::string& text) {
+    auto [type, data] = Protocol::parse_message(text);
+    std::vector<Event> events;
+    events.reserve(data.size());
+    for (const auto& item : data) {
+        events.push_back(Event::from_json(item));
+    }
+    return events;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::string text = make_message(count);
+
+    DecodedMessage decoded;
+    if (!MessageDecoder::decode(text, decoded) || decoded.type != Protocol::EVENT_LIST) {
+        std::printf("MessageDecoder rejected the message\n");
+        return 1;
+    }
+    auto expected = dom_decode(text);
+    if (decoded.events.size() != expected.size()) {
+        std::printf("MISMATCH: %zu vs %zu events\n", decoded.events.size(), expected.size());
+        return 1;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (decoded.events[i].to_json() != expected[i].to_json()) {
+            std::printf("MISMATCH at event %zu\n", i);
+            return 1;
+        }
+    }
+    std::printf("%d events, %zu byte message, decoded events identical\n", count, text.size());
+
+    double dom_ms = 0, sax_ms = 0;
+    size_t decoded_events = 0;
+    for (int round = 0; round < rounds; ++round) {
+        Timer dom_timer;
+        decoded_events += dom_decode(text).size();
+        dom_ms += dom_timer.elapsed_ms();
+
+        Timer sax_timer;
+        MessageDecoder::decode(text, decoded);
+        decoded_events += decoded.events.size();
+        sax_ms += sax_timer.elapsed_ms();
+    }
+
+    auto report = [&](const char* label, double ms) {
+        double seconds = ms / 1000.0;
+        std::printf("  %-28s %8.1f ms/message  %7.2f M events/s  %7.1f MiB/s\n", label, ms / rounds,
+                    count * rounds / seconds / 1e6, text.size() * rounds / seconds / (1024.0 * 1024.0));
+    };
+    report("parse_message + from_json", dom_ms);
+    report("MessageDecoder, reused", sax_ms);
+    return decoded_events == 0;
+}
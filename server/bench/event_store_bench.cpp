@@ -0,0 +1,116 @@
+// Memory footprint and query latency of the in-memory EventStore, and the
+// same queries answered by SQLite (DatabaseOptions::cache_events off) on an
+// identical events table.
+//
+// Usage: event_store_bench [events=1000000] [dir=.] [sqlite=1]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include "EventStore.h"
+#include <malloc.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace {
+
+size_t heap_in_use() {
+    return mallinfo2().uordblks;
+}
+
+template <typename Lookup>
+void time_point_reads(const char* label, int events, Lookup lookup) {
+    const int reads = 200000;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(1, events);
+
+    Timer timer;
+    size_t found = 0;
+    for (int i = 0; i < reads; ++i) {
+        found += lookup(pick(rng));
+    }
+    std::printf("  %-28s %10.3f us/op  (%zu of %d hits)\n", label, timer.elapsed_us() / reads, found, reads);
+}
+
+template <typename Scan>
+void time_scan(const char* label, Scan scan) {
+    Timer timer;
+    size_t rows = scan();
+    std::printf("  %-28s %10.1f ms     (%zu rows)\n", label, timer.elapsed_us() / 1000.0, rows);
+}
+
+void bench_store(int events) {
+    std::printf("EventStore, %d events\n", events);
+    auto base = std::chrono::system_clock::now();
+
+    size_t heap_before = heap_in_use();
+    EventStore store;
+    Timer build_timer;
+    {
+        std::vector<std::pair<int, EventPtr>> chunk;
+        for (int i = 0; i < events; ++i) {
+            // The ids SQLite gives the same rows in populate()
+            Event event = make_event(i, base);
+            event.id = i + 1;
+            event.version = 1;
+            chunk.emplace_back(event.id, std::make_shared<const Event>(std::move(event)));
+            if (chunk.size() == 65536 || i == events - 1) {
+                store.publish(chunk);
+                chunk.clear();
+            }
+        }
+    }
+    double build_ms = build_timer.elapsed_us() / 1000.0;
+    size_t heap_after = heap_in_use();
+
+    std::printf("  %-28s %10.1f ms\n", "build", build_ms);
+    std::printf("  %-28s %10.1f bytes/event (%.1f MiB total, sizeof(Event) = %zu)\n", "memory",
+                static_cast<double>(heap_after - heap_before) / events,
+                (heap_after - heap_before) / (1024.0 * 1024.0), sizeof(Event));
+
+    time_point_reads("find by id", events, [&](int id) { return store.find(id) != nullptr; });
+    time_scan("all, by event_time", [&]() { return store.all().size(); });
+    time_scan("one user, by event_time", [&]() { return store.for_user(7).size(); });
+    time_scan("pending reminders", [&]() { return store.pending_reminders().size(); });
+}
+
+void bench_database(int events, const std::string& dir) {
+    std::string path = dir + "/event_store_bench.db";
+    remove_database(path);
+    if (!populate(path, events)) {
+        std::fprintf(stderr, "cannot create %s\n", path.c_str());
+        return;
+    }
+
+    for (bool cached : {false, true}) {
+        std::printf("\nDatabase, cache_events=%s\n", cached ? "on" : "off");
+        DatabaseOptions options;
+        options.cache_events = cached;
+
+        Timer open_timer;
+        Database database(path, options);
+        std::printf("  %-28s %10.1f ms\n", "open (+ load)", open_timer.elapsed_us() / 1000.0);
+
+        time_point_reads("find_event", events, [&](int id) { return database.find_event(id) != nullptr; });
+        time_scan("list_events", [&]() { return database.list_events().size(); });
+        time_scan("get_events_for_user", [&]() { return database.get_events_for_user(7).size(); });
+    }
+
+    remove_database(path);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int events = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    std::string dir = argc > 2 ? argv[2] : ".";
+    bool with_sqlite = argc > 3 ? std::atoi(argv[3]) != 0 : true;
+
+    bench_store(events);
+    if (with_sqlite) {
+        bench_database(events, dir);
+    }
+    return 0;
+}
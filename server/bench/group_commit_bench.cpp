@@ -0,0 +1,92 @@
+// Event insert throughput with and without group commit under bursty load:
+// one producer queueing creates asynchronously (an import or scripted
+// client) and several threads issuing blocking creates at once.
+//
+// Usage: group_commit_bench [events=20000] [threads=16] [profile=durable] [dir=.]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+double async_burst(Database& database, int events) {
+    std::atomic<int> remaining{events};
+    std::promise<void> finished;
+    auto all_done = finished.get_future();
+
+    Timer timer;
+    for (int i = 0; i < events; ++i) {
+        database.create_event_async(make_event(i, std::chrono::system_clock::now(), 50), [&](EventPtr) {
+            if (remaining.fetch_sub(1) == 1) finished.set_value();
+        });
+    }
+    all_done.wait();
+    return events / timer.elapsed_s();
+}
+
+double concurrent_sync(Database& database, int events, int threads) {
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int i = t; i < events; i += threads) {
+                database.create_event(make_event(i, std::chrono::system_clock::now(), 50));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return events / timer.elapsed_s();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int events = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 16;
+    std::string profile_name = argc > 3 ? argv[3] : "durable";
+    std::string dir = argc > 4 ? argv[4] : ".";
+    std::string path = dir + "/group_commit_bench.db";
+
+    DatabaseProfile profile;
+    if (!DatabaseOptions::parse_profile(profile_name, profile)) {
+        std::fprintf(stderr, "unknown profile %s\n", profile_name.c_str());
+        return 1;
+    }
+
+    std::printf("%d events, profile %s\n\n", events, profile_name.c_str());
+    std::string sync_label = "sync x" + std::to_string(threads) + " ev/s";
+    std::printf("%-22s %16s %22s\n", "", "async burst ev/s", sync_label.c_str());
+
+    struct Config {
+        const char* label;
+        int max_batch;
+    };
+    for (const Config& config : {Config{"no group commit", 1}, Config{"group commit (128)", 128}}) {
+        DatabaseOptions options = DatabaseOptions::for_profile(profile);
+        options.group_commit_max_batch = config.max_batch;
+
+        remove_database(path);
+        double burst;
+        double sync;
+        {
+            Database database(path, options);
+            burst = async_burst(database, events);
+            sync = concurrent_sync(database, events, threads);
+            database.log_statement_stats();
+        }
+        std::printf("%-22s %16.0f %22.0f\n\n", config.label, burst, sync);
+    }
+
+    remove_database(path);
+    return 0;
+}
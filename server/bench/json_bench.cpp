@@ -0,0 +1,94 @@
+// An event_list message serialized the old way (Event::to_json per row into
+// a json array, Protocol::create_message, dump()) against streaming it
+// with JsonWriter into a reused buffer. Checks the two outputs are the
+// same bytes (apart from the envelope timestamp) before timing them.
+//
+// Usage: json_bench [events=100000] [rounds=5]
+
+#include "BenchUtil.h"
+#include "Event.h"
+#include "JsonWriter.h"
+#include "Protocol.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<Event> make_events(int count) {
+    auto base = std::chrono::system_clock::now();
+    std::vector<Event> events;
+    events.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        events.push_back(text_event(i, base));
+    }
+    return events;
+}
+
+std::string dom_message(const std::vector<Event>& events) {
+    nlohmann::json events_json = nlohmann::json::array();
+    for (const auto& event : events) {
+        events_json.push_back(event.to_json());
+    }
+    return Protocol::create_message(Protocol::EVENT_LIST, events_json).dump();
+}
+
+void streamed_message(const std::vector<Event>& events, std::string& out) {
+    out.clear();
+    Protocol::write_message(out, Protocol::EVENT_LIST, [&](JsonWriter& writer) {
+        writer.begin_array();
+        for (const auto& event : events) {
+            event.write_json(writer);
+        }
+        writer.end_array();
+    });
+}
+
+std::string without_timestamp(const std::string& message) {
+    static const std::regex timestamp("\"timestamp\":[0-9]+");
+    return std::regex_replace(message, timestamp, "\"timestamp\":0");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    auto events = make_events(count);
+
+    std::string buffer;
+    streamed_message(events, buffer);
+    std::string expected = dom_message(events);
+    if (without_timestamp(buffer) != without_timestamp(expected)) {
+        std::printf("MISMATCH: streamed output differs from dump() (%zu vs %zu bytes)\n",
+                    buffer.size(), expected.size());
+        return 1;
+    }
+    std::printf("%d events, %zu byte message, outputs identical\n", count, buffer.size());
+
+    double dom_ms = 0, stream_ms = 0;
+    size_t bytes = 0;
+    for (int round = 0; round < rounds; ++round) {
+        Timer dom_timer;
+        bytes += dom_message(events).size();
+        dom_ms += dom_timer.elapsed_ms();
+
+        Timer stream_timer;
+        streamed_message(events, buffer);
+        bytes += buffer.size();
+        stream_ms += stream_timer.elapsed_ms();
+    }
+
+    auto report = [&](const char* label, double ms) {
+        double seconds = ms / 1000.0;
+        std::printf("  %-28s %8.1f ms/message  %7.2f M events/s  %7.1f MiB/s\n", label, ms / rounds,
+                    count * rounds / seconds / 1e6, buffer.size() * rounds / seconds / (1024.0 * 1024.0));
+    };
+    report("to_json + create_message", dom_ms);
+    report("JsonWriter, reused buffer", stream_ms);
+    return bytes == 0;
+}
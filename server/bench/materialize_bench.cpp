@@ -0,0 +1,108 @@
+// Heap allocations and time spent turning events rows into Event objects:
+// the startup load into the EventStore and a full SQLite listing
+// (DatabaseOptions::cache_events off). Counts come from a replaced global
+// operator new, so they include every std::string and shared_ptr block.
+//
+// Usage: materialize_bench [events=100000] [dir=.]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_allocated_bytes{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct AllocationScope {
+    size_t allocations = g_allocations.load();
+    size_t bytes = g_allocated_bytes.load();
+    void report(const char* label, double ms, size_t rows) const {
+        size_t count = g_allocations.load() - allocations;
+        size_t total = g_allocated_bytes.load() - bytes;
+        std::printf("  %-24s %9.1f ms  %9zu allocations (%.2f/row, %.1f MiB)\n", label, ms, count,
+                    rows ? static_cast<double>(count) / rows : 0.0, total / (1024.0 * 1024.0));
+    }
+};
+
+// A few creators own everything, titles and descriptions are past the
+// small-string buffer, as with real event text
+const char* const kCreators[] = {"alice", "bob", "carol", "dave", "erin", "frank", "grace", "heidi"};
+
+Event make_row(int i, std::chrono::system_clock::time_point base) {
+    Event event(1 + i % 8, "Weekly planning session #" + std::to_string(i),
+                "Agenda and notes are in the shared folder", base + std::chrono::minutes(i), kCreators[i % 8]);
+    event.reminder_time = event.event_time - std::chrono::minutes(15);
+    event.created_at = base;
+    return event;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int events = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::string dir = argc > 2 ? argv[2] : ".";
+    std::string path = dir + "/materialize_bench.db";
+
+    remove_database(path);
+    auto base = std::chrono::system_clock::now();
+    if (!populate(path, events, [&](int i) { return make_row(i, base); })) {
+        std::fprintf(stderr, "cannot create %s\n", path.c_str());
+        return 1;
+    }
+    std::printf("%d events\n", events);
+
+    {
+        DatabaseOptions options;
+        options.cache_events = true;
+        AllocationScope scope;
+        Timer timer;
+        Database database(path, options);
+        scope.report("open + load", timer.elapsed_ms(), events);
+
+        AllocationScope list_scope;
+        Timer list_timer;
+        size_t rows = database.list_events().size();
+        list_scope.report("list_events (store)", list_timer.elapsed_ms(), rows);
+    }
+
+    {
+        DatabaseOptions options;
+        options.cache_events = false;
+        Database database(path, options);
+
+        for (int round = 0; round < 2; ++round) {
+            AllocationScope scope;
+            Timer timer;
+            size_t rows = database.list_events().size();
+            scope.report("list_events (sqlite)", timer.elapsed_ms(), rows);
+        }
+    }
+
+    remove_database(path);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Read throughput of the reader connection pool while a writer thread keeps
+// updating events. Every run uses the same number of reader threads; only
+// the number of reader connections changes (0 = reads queue on the writer).
+//
+// Usage: mixed_rw_bench [events=100000] [seconds=3] [threads=8] [dir=.]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kUsers = 1000;
+
+void run(const std::string& path, int connections, int threads, int events, int seconds) {
+    DatabaseOptions options;
+    options.reader_connections = connections;
+    // Measures SQLite reader connections, not the in-memory event store
+    options.cache_events = false;
+    Database database(path, options);
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> writes{0};
+
+    std::thread writer([&]() {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pick(1, events);
+        auto now = std::chrono::system_clock::now();
+        while (running) {
+            Event event(1, "Updated", "Rewritten by the writer thread", now + std::chrono::hours(1), "bench");
+            event.id = pick(rng);
+            event.user_id = 1 + (event.id - 1) % kUsers;
+            database.update_event(event);
+            writes.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // Mostly point lookups with an occasional per-user listing (~100 rows)
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t]() {
+            std::mt19937 rng(100 + t);
+            std::uniform_int_distribution<int> pick_event(1, events);
+            std::uniform_int_distribution<int> pick_user(1, kUsers);
+            uint64_t local = 0;
+            while (running) {
+                if (local % 10 == 9) {
+                    database.get_events_for_user(pick_user(rng));
+                } else {
+                    database.get_event_by_id(pick_event(rng));
+                }
+                ++local;
+            }
+            reads.fetch_add(local, std::memory_order_relaxed);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    std::printf("%11d %12.0f %12.0f\n", connections,
+                reads.load() / static_cast<double>(seconds),
+                writes.load() / static_cast<double>(seconds));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int events = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 8;
+    std::string dir = argc > 4 ? argv[4] : ".";
+    std::string path = dir + "/mixed_rw_bench.db";
+
+    remove_database(path);
+    if (!populate(path, events, kUsers)) {
+        std::fprintf(stderr, "cannot create %s\n", path.c_str());
+        return 1;
+    }
+
+    std::printf("%d events, %d reader threads + 1 writer, %d s per run\n\n", events, threads, seconds);
+    std::printf("%11s %12s %12s\n", "connections", "reads/s", "writes/s");
+    for (int connections : {0, 1, 2, 4, 8}) {
+        run(path, connections, threads, events, seconds);
+    }
+
+    remove_database(path);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Parses a mix of protocol messages three ways: plain json::parse (the
+// nlohmann baseline), Protocol::parse_message, and what on_message does
+// (MessageDecoder, falling back to parse_message). The last two use
+// simdjson when the build has it (USE_SIMDJSON=ON), so run this from both
+// builds to compare.
+//
+// The mix is a RECORD_MESSAGES file from a real server (one frame per
+// line) or, without one, a generated mix of both directions: requests as
+// clients send them and the broadcasts, reminders and event lists they
+// get back.
+//
+// Usage: parse_mix_bench [recording] [rounds=5]
+
+#include "BenchUtil.h"
+#include "Event.h"
+#include "JsonWriter.h"
+#include "MessageDecoder.h"
+#include "Protocol.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string request(const std::string& type, const nlohmann::json& data) {
+    return Protocol::create_message(type, data).dump();
+}
+
+std::string event_message(const std::string& type, const std::vector<Event>& events, bool as_list) {
+    std::string out;
+    Protocol::write_message(out, type, [&](JsonWriter& writer) {
+        if (as_list) writer.begin_array();
+        for (const auto& event : events) {
+            event.write_json(writer);
+        }
+        if (as_list) writer.end_array();
+    });
+    return out;
+}
+
+// Per 100 frames, roughly what a busy server and its clients see
+std::vector<std::string> generated_mix() {
+    auto base = std::chrono::system_clock::now();
+    const std::string token(64, 'a');
+    std::vector<std::string> messages;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 30; ++i) {
+            messages.push_back(request(Protocol::HEARTBEAT, nullptr));
+        }
+        for (int i = 0; i < 15; ++i) {
+            auto data = text_event(round * 15 + i, base).to_json();
+            data["auth_token"] = token;
+            messages.push_back(request(i % 3 ? Protocol::EVENT_UPDATE : Protocol::EVENT_CREATE, data));
+        }
+        for (int i = 0; i < 5; ++i) {
+            messages.push_back(request(Protocol::EVENT_DELETE, {{"auth_token", token}, {"id", i}, {"version", 2}}));
+        }
+        messages.push_back(request(Protocol::AUTH_LOGIN, {{"username", "user7"}, {"password", "secret12"}}));
+        messages.push_back(request(Protocol::EVENT_LIST, {{"auth_token", token}}));
+        nlohmann::json operations = nlohmann::json::array();
+        for (int i = 0; i < 20; ++i) {
+            operations.push_back({{"op", "update"}, {"event", text_event(i, base).to_json()}});
+        }
+        messages.push_back(request(Protocol::EVENT_BATCH, {{"auth_token", token}, {"operations", operations}}));
+
+        for (int i = 0; i < 40; ++i) {
+            std::string out;
+            Event event = text_event(round * 40 + i, base);
+            Protocol::write_message(out, Protocol::EVENT_UPDATE, [&](JsonWriter& writer) {
+                event.write_json(writer, {{"action", [](JsonWriter& w) { w.value("updated"); }}});
+            });
+            messages.push_back(out);
+        }
+        messages.push_back(event_message(Protocol::REMINDER, {text_event(round, base)}, false));
+        std::vector<Event> listed;
+        for (int i = 0; i < (round % 10 == 0 ? 1000 : 50); ++i) {
+            listed.push_back(text_event(i, base));
+        }
+        messages.push_back(event_message(Protocol::EVENT_LIST, listed, true));
+    }
+    return messages;
+}
+
+std::string type_of(const std::string& message) {
+    try {
+        return Protocol::parse_message(message).first;
+    } catch (const std::exception&) {
+        return "(invalid)";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> messages;
+    if (argc > 1) {
+        std::ifstream in(argv[1]);
+        if (!in) {
+            std::printf("cannot open %s\n", argv[1]);
+            return 1;
+        }
+        for (std::string line; std::getline(in, line);) {
+            if (!line.empty()) messages.push_back(line);
+        }
+    } else {
+        messages = generated_mix();
+    }
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    struct Totals {
+        size_t count = 0, bytes = 0, decoded = 0;
+        double dom_ms = 0, parse_ms = 0, server_ms = 0;
+    };
+    std::map<std::string, Totals> by_type;
+    Totals all;
+    DecodedMessage decoded;
+    size_t sink = 0;   // keeps the parses from being optimized away
+
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& message : messages) {
+            Totals& totals = by_type[type_of(message)];
+
+            Timer dom_timer;
+            try {
+                sink += nlohmann::json::parse(message).size();
+            } catch (const std::exception&) {}
+            double dom_ms = dom_timer.elapsed_ms();
+
+            Timer parse_timer;
+            try {
+                sink += Protocol::parse_message(message).second.size();
+            } catch (const std::exception&) {}
+            double parse_ms = parse_timer.elapsed_ms();
+
+            Timer server_timer;
+            bool fast = MessageDecoder::decode(message, decoded);
+            if (!fast) {
+                try {
+                    sink += Protocol::parse_message(message).second.size();
+                } catch (const std::exception&) {}
+            }
+            double server_ms = server_timer.elapsed_ms();
+
+            for (Totals* t : {&totals, &all}) {
+                t->count += 1;
+                t->bytes += message.size();
+                t->decoded += fast;
+                t->dom_ms += dom_ms;
+                t->parse_ms += parse_ms;
+                t->server_ms += server_ms;
+            }
+        }
+    }
+
+    std::printf("%zu messages, parser: %s\n\n", messages.size(), Protocol::json_parser().c_str());
+    std::printf("%-18s %8s %10s %8s   %-22s %-22s %-22s\n", "type", "frames", "avg bytes", "decoded",
+                "json::parse", "parse_message", "decode/fallback");
+    auto mib_s = [](size_t bytes, double ms) { return bytes / (ms / 1000.0) / (1024.0 * 1024.0); };
+    auto row = [&](const std::string& name, const Totals& t) {
+        std::printf("%-18s %8zu %10zu %7.0f%%   %8.1f ms %7.1f MiB/s %8.1f ms %7.1f MiB/s %8.1f ms %7.1f MiB/s\n",
+                    name.c_str(), t.count / rounds, t.bytes / t.count, 100.0 * t.decoded / t.count,
+                    t.dom_ms, mib_s(t.bytes, t.dom_ms), t.parse_ms, mib_s(t.bytes, t.parse_ms),
+                    t.server_ms, mib_s(t.bytes, t.server_ms));
+    };
+    for (const auto& [type, totals] : by_type) {
+        row(type, totals);
+    }
+    row("all", all);
+    return sink == 0;
+}
@@ -0,0 +1,107 @@
+// Weekly series stored the old way (one row per occurrence) against one
+// row per series with a recurrence rule: import time, database size, and
+// the cost and payload of listing one week and of listing everything.
+//
+// Usage: recurrence_bench [series=500] [weeks=104] [db_path=recurrence_bench.db]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+
+namespace {
+
+long file_size(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<long>(info.st_size) : 0;
+}
+
+std::vector<Event> make_series(int series, int weeks, bool as_rules, std::chrono::system_clock::time_point start) {
+    std::vector<Event> events;
+    for (int s = 0; s < series; ++s) {
+        Event event(1 + s % 50, "Weekly sync " + std::to_string(s), "Recurrence benchmark",
+                    start + std::chrono::minutes(37 * s), "bench");
+        event.reminder_time = event.event_time - std::chrono::minutes(15);
+        if (as_rules) {
+            event.recurrence.frequency = Recurrence::Weekly;
+            event.recurrence.count = weeks;
+            events.push_back(std::move(event));
+            continue;
+        }
+        for (int w = 0; w < weeks; ++w) {
+            Event occurrence = event;
+            occurrence.event_time += std::chrono::hours(24 * 7 * w);
+            occurrence.reminder_time += std::chrono::hours(24 * 7 * w);
+            events.push_back(std::move(occurrence));
+        }
+    }
+    return events;
+}
+
+// What handle_event_list would send, occurrences included
+size_t payload_bytes(const std::vector<EventPtr>& events, bool windowed,
+                     std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) {
+    size_t bytes = 0;
+    for (const auto& event : events) {
+        nlohmann::json j = event->to_json();
+        if (windowed && event->recurrence.is_recurring()) {
+            nlohmann::json starts = nlohmann::json::array();
+            for (const auto& start : event->recurrence.occurrences_between(event->event_time, from, to)) {
+                starts.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    start.time_since_epoch()).count());
+            }
+            j["occurrences"] = std::move(starts);
+        }
+        bytes += j.dump().size();
+    }
+    return bytes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int series = argc > 1 ? std::atoi(argv[1]) : 500;
+    int weeks = argc > 2 ? std::atoi(argv[2]) : 104;
+    std::string path = argc > 3 ? argv[3] : "recurrence_bench.db";
+
+    auto start = std::chrono::system_clock::now() + std::chrono::hours(1);
+    auto week_from = start + std::chrono::hours(24 * 7 * 50);
+    auto week_to = week_from + std::chrono::hours(24 * 7);
+
+    for (bool cached : {false, true}) {
+        std::printf("cache_events=%s, %d weekly series x %d weeks\n", cached ? "on" : "off", series, weeks);
+        for (bool as_rules : {false, true}) {
+            remove_database(path);
+            DatabaseOptions options;
+            options.cache_events = cached;
+            Database database(path, options);
+
+            auto events = make_series(series, weeks, as_rules, start);
+            Timer import_timer;
+            database.import_events(events);
+            double import_ms = import_timer.elapsed_ms();
+            database.checkpoint(true);
+
+            Timer week_timer;
+            auto week = database.list_events_between(week_from, week_to);
+            double week_ms = week_timer.elapsed_ms();
+
+            Timer all_timer;
+            auto all = database.list_events();
+            double all_ms = all_timer.elapsed_ms();
+
+            std::printf("  %-18s %7zu rows  import %8.1f ms  db %7ld KiB\n",
+                        as_rules ? "rule per series" : "row per occurrence", events.size(), import_ms,
+                        file_size(path) / 1024);
+            std::printf("  %-18s one week: %5zu events %7.2f ms %8zu B   everything: %7zu events %7.2f ms %9zu B\n",
+                        "", week.size(), week_ms, payload_bytes(week, true, week_from, week_to),
+                        all.size(), all_ms, payload_bytes(all, false, week_from, week_to));
+        }
+    }
+
+    remove_database(path);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Fast-forwards ReminderManager through a simulated stretch of time on a
+// VirtualClock. Reminders are spread over whole minutes of the period (as
+// users pick them); the clock jumps from one due time to the next, and
+// each wakeup moves it on by the wall time the wakeup really took. A
+// reminder's lateness is its wakeup's due time plus the wall time spent in
+// the wakeup before the callback got it, so slow ticks show up.
+//
+// Reports reminder lateness percentiles, CPU per wakeup and the database
+// writes the schedule cost.
+//
+// Usage: reminder_sim [events=1000000] [days=7] [db_path=reminder_sim.db]
+
+#include "BenchUtil.h"
+#include "Clock.h"
+#include "Database.h"
+#include "ReminderManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+
+namespace {
+
+template <typename T>
+T percentile(std::vector<T>& values, double p) {
+    if (values.empty()) return T();
+    size_t index = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+uint64_t executions(Database& database, const std::string& name) {
+    for (const auto& stats : database.get_statement_stats()) {
+        if (stats.name == name) return stats.executions;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int days = argc > 2 ? std::atoi(argv[2]) : 7;
+    std::string path = argc > 3 ? argv[3] : "reminder_sim.db";
+
+    remove_database(path);
+    Database database(path);
+
+    // Whole minutes, like everything else the client lets users choose
+    auto start = std::chrono::time_point_cast<std::chrono::minutes>(std::chrono::system_clock::now()) +
+                 std::chrono::minutes(1);
+    auto end = start + std::chrono::hours(24 * days);
+    {
+        Timer timer;
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> minute(0, days * 24 * 60 - 1);
+        const int kChunk = 100000;
+        for (int loaded = 0; loaded < count; loaded += kChunk) {
+            std::vector<Event> events;
+            events.reserve(kChunk);
+            for (int i = loaded; i < std::min(count, loaded + kChunk); ++i) {
+                Event event(1 + i % 1000, "Event " + std::to_string(i), "", start, "sim");
+                event.reminder_time = start + std::chrono::minutes(minute(rng));
+                event.event_time = event.reminder_time + std::chrono::minutes(15);
+                events.push_back(std::move(event));
+            }
+            database.import_events(events);
+        }
+        std::printf("loaded %d events over %d days in %.1f s\n", count, days, timer.elapsed_ms() / 1000);
+    }
+
+    VirtualClock clock(start);
+    ReminderManager reminders(&database, clock);
+
+    std::vector<double> lateness_ms;
+    lateness_ms.reserve(count);
+    auto wall_start = std::chrono::steady_clock::now();
+    reminders.setReminderCallback([&](const std::vector<EventPtr>& events) {
+        auto delivered = clock.now() + std::chrono::duration_cast<Clock::time_point::duration>(
+            std::chrono::steady_clock::now() - wall_start);
+        for (const auto& event : events) {
+            lateness_ms.push_back(std::chrono::duration<double, std::milli>(delivered - event->reminder_time).count());
+        }
+    });
+
+    Timer load_timer;
+    reminders.load();
+    std::printf("scheduled %zu reminders in %.1f ms\n", reminders.scheduledCount(), load_timer.elapsed_ms());
+
+    uint64_t marks_before = executions(database, "mark_reminders_sent");
+    uint64_t commits_before = executions(database, "commit");
+
+    std::vector<double> tick_cpu_us;
+    Timer run_timer;
+    for (;;) {
+        auto due = reminders.nextDue();
+        if (due >= end) break;
+        if (clock.now() < due) clock.set(due);
+
+        std::clock_t cpu_start = std::clock();
+        wall_start = std::chrono::steady_clock::now();
+        reminders.runDue();
+        // std::clock() counts every thread, so the writer's commit is included
+        tick_cpu_us.push_back(1e6 * (std::clock() - cpu_start) / CLOCKS_PER_SEC);
+        clock.advance(std::chrono::duration_cast<Clock::time_point::duration>(
+            std::chrono::steady_clock::now() - wall_start));
+    }
+    double run_ms = run_timer.elapsed_ms();
+
+    size_t sent = lateness_ms.size();
+    double cpu_total = 0;
+    for (double us : tick_cpu_us) cpu_total += us;
+
+    std::printf("simulated %d days in %.1f s: %zu wakeups, %zu reminders sent, %zu still scheduled\n",
+                days, run_ms / 1000, tick_cpu_us.size(), sent, reminders.scheduledCount());
+    std::printf("lateness ms   p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+                percentile(lateness_ms, 0.50), percentile(lateness_ms, 0.90),
+                percentile(lateness_ms, 0.99), percentile(lateness_ms, 1.0));
+    std::printf("cpu/wakeup us mean %.0f  p50 %.0f  p99 %.0f  max %.0f\n",
+                tick_cpu_us.empty() ? 0.0 : cpu_total / tick_cpu_us.size(),
+                percentile(tick_cpu_us, 0.50), percentile(tick_cpu_us, 0.99), percentile(tick_cpu_us, 1.0));
+    std::printf("db writes     %llu mark_reminders_sent, %llu commits\n",
+                static_cast<unsigned long long>(executions(database, "mark_reminders_sent") - marks_before),
+                static_cast<unsigned long long>(executions(database, "commit") - commits_before));
+
+    reminders.stop();
+    remove_database(path);
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Cost of one reminder tick with N reminders due: the old per-event path
+// (update_event rewriting every column of each row) against the due-window
+// query plus a single batched reminder_sent UPDATE.
+//
+// Usage: reminder_tick_bench [due=10000] [future=100000] [db_path=reminder_tick_bench.db]
+
+#include "BenchUtil.h"
+#include "Database.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+// `due` reminders already due, `future` ones due next month
+void populate(Database& database, int due, int future) {
+    auto now = std::chrono::system_clock::now();
+    std::vector<Event> events;
+    events.reserve(due + future);
+    for (int i = 0; i < due + future; ++i) {
+        bool is_due = i < due;
+        Event event(1 + i % 50, "Event " + std::to_string(i), "Reminder benchmark",
+                    now + (is_due ? std::chrono::hours(1) : std::chrono::hours(24 * 30)), "bench");
+        event.reminder_time = is_due ? now - std::chrono::seconds(1) : event.event_time - std::chrono::minutes(15);
+        events.push_back(std::move(event));
+    }
+    database.import_events(events);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int due = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int future = argc > 2 ? std::atoi(argv[2]) : 100000;
+    std::string path = argc > 3 ? argv[3] : "reminder_tick_bench.db";
+
+    for (bool cached : {false, true}) {
+        std::printf("cache_events=%s, %d due, %d in the future\n", cached ? "on" : "off", due, future);
+        DatabaseOptions options;
+        options.cache_events = cached;
+
+        {
+            remove_database(path);
+            Database database(path, options);
+            populate(database, due, future);
+
+            Timer timer;
+            size_t sent = 0;
+            auto now = std::chrono::system_clock::now();
+            for (auto& event : database.get_events_needing_reminder()) {
+                if (!event.reminder_sent && now >= event.reminder_time && now < event.event_time) {
+                    event.reminder_sent = true;
+                    sent += database.update_event(event);
+                }
+            }
+            std::printf("  %-36s %9.1f ms  (%zu sent)\n", "scan all unsent + update_event each", timer.elapsed_ms(), sent);
+        }
+
+        {
+            remove_database(path);
+            Database database(path, options);
+            populate(database, due, future);
+
+            Timer timer;
+            size_t sent = 0;
+            auto now = std::chrono::system_clock::now();
+            std::vector<int> ids;
+            for (;;) {
+                auto events = database.get_due_reminders(now, 1000, ids);
+                if (events.empty() && ids.empty()) break;
+                for (const auto& event : events) ids.push_back(event.id);
+                sent += database.mark_reminders_sent(ids).size();
+            }
+            std::printf("  %-36s %9.1f ms  (%zu sent)\n", "due window + batched mark", timer.elapsed_ms(), sent);
+        }
+    }
+
+    remove_database(path);
+    return 0;
+}
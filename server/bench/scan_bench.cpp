@@ -0,0 +1,128 @@
+// Scan throughput of EventColumns against a plain std::vector<Event> for the
+// two scan-heavy queries: events in a time window and due reminders.
+//
+// Usage: scan_bench [events=1000000] [rounds=20]
+
+#include "BenchUtil.h"
+#include "EventColumns.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using WallClock = std::chrono::system_clock;
+
+// Events spread over a year; a quarter of them already reminded
+std::vector<Event> make_events(int count, WallClock::time_point base) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> minutes(0, 365 * 24 * 60);
+    std::uniform_int_distribution<int> lead(5, 24 * 60);
+
+    std::vector<Event> events;
+    events.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Event event = make_event(i, base);
+        event.id = i + 1;
+        event.version = 1;
+        event.event_time = base + std::chrono::minutes(minutes(rng));
+        event.reminder_time = event.event_time - std::chrono::minutes(lead(rng));
+        event.reminder_sent = (i % 4) == 0;
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+template <typename Scan>
+void report(const char* label, int rows, int rounds, Scan scan) {
+    size_t matches = scan();  // warm-up
+    Timer timer;
+    for (int i = 0; i < rounds; ++i) {
+        matches = scan();
+    }
+    double us = timer.elapsed_us() / rounds;
+    std::printf("  %-34s %9.2f ms  %8.1f Mrows/s  (%zu matches)\n", label, us / 1000.0, rows / us, matches);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    auto base = WallClock::now();
+    std::vector<Event> events = make_events(count, base);
+
+    EventColumns columns;
+    columns.reserve(count);
+    for (const auto& event : events) {
+        columns.upsert(event);
+    }
+
+    size_t text_bytes = 0;
+    for (const auto& event : events) {
+        text_bytes += event.title.capacity() + event.description.capacity() + event.creator.capacity();
+    }
+    std::printf("%d events, %d rounds\n", count, rounds);
+    std::printf("  %-34s %9.1f MiB (sizeof(Event) = %zu, plus heap strings)\n", "vector<Event>",
+                (events.capacity() * sizeof(Event) + text_bytes) / (1024.0 * 1024.0), sizeof(Event));
+    std::printf("  %-34s %9.1f MiB\n", "EventColumns", columns.memory_bytes() / (1024.0 * 1024.0));
+
+    // One week starting a month out, ~2% of the rows
+    auto from = base + std::chrono::hours(24 * 30);
+    auto to = from + std::chrono::hours(24 * 7);
+    int64_t from_ms = std::chrono::duration_cast<std::chrono::milliseconds>(from.time_since_epoch()).count();
+    int64_t to_ms = std::chrono::duration_cast<std::chrono::milliseconds>(to.time_since_epoch()).count();
+
+    // "now" a day in, so reminders of events later that day are due
+    auto now = base + std::chrono::hours(24);
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+
+    std::printf("\ntime window count\n");
+    report("vector<Event>", count, rounds, [&]() {
+        size_t n = 0;
+        for (const auto& event : events) {
+            n += event.event_time >= from && event.event_time < to;
+        }
+        return n;
+    });
+    report("EventColumns::count_in_window", count, rounds, [&]() {
+        return columns.count_in_window(from_ms, to_ms);
+    });
+
+    std::printf("\ntime window select (row ids)\n");
+    std::vector<uint32_t> rows;
+    report("vector<Event>", count, rounds, [&]() {
+        rows.clear();
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (events[i].event_time >= from && events[i].event_time < to) {
+                rows.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return rows.size();
+    });
+    report("EventColumns::select_in_window", count, rounds, [&]() {
+        columns.select_in_window(from_ms, to_ms, rows);
+        return rows.size();
+    });
+
+    std::printf("\ndue reminders\n");
+    report("vector<Event>", count, rounds, [&]() {
+        rows.clear();
+        for (size_t i = 0; i < events.size(); ++i) {
+            const Event& event = events[i];
+            if (!event.reminder_sent && now >= event.reminder_time && now < event.event_time) {
+                rows.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return rows.size();
+    });
+    report("EventColumns::select_due_reminders", count, rounds, [&]() {
+        columns.select_due_reminders(now_ms, rows);
+        return rows.size();
+    });
+
+    return 0;
+}
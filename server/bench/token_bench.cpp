@@ -0,0 +1,69 @@
+// Compares session token validation: opaque tokens looked up in
+// AuthManager's map versus stateless HMAC-signed tokens.
+//
+// Usage: token_bench [token_count] [iterations]
+
+#include "BenchUtil.h"
+#include "AuthManager.h"
+#include "Database.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> login_all(AuthManager& auth, int count) {
+    std::vector<std::string> tokens;
+    tokens.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        AuthToken token = auth.login("bench_user", "bench_password");
+        tokens.push_back(token.token);
+    }
+    return tokens;
+}
+
+void run(const char* label, AuthManager& auth, const std::vector<std::string>& tokens, int iterations) {
+    size_t valid = 0;
+    Timer timer;
+    for (int i = 0; i < iterations; ++i) {
+        valid += auth.get_user_id_by_token(tokens[i % tokens.size()]) > 0;
+    }
+    double ns = timer.elapsed_ns();
+    std::printf("%-28s %10.1f ns/validation  (%zu/%d valid)\n", label, ns / iterations, valid, iterations);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int token_count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 1000000;
+
+    Database database(":memory:");
+    AuthManager opaque(&database);
+    if (!opaque.register_user("bench_user", "bench@example.com", "bench_password")) {
+        std::fprintf(stderr, "failed to register benchmark user\n");
+        return 1;
+    }
+
+    std::printf("tokens: %d, iterations: %d\n", token_count, iterations);
+
+    // Opaque tokens: hash map lookup under a mutex
+    auto opaque_tokens = login_all(opaque, token_count);
+    run("opaque (map lookup)", opaque, opaque_tokens, iterations);
+
+    // Signed tokens: HMAC-SHA256 verification plus revocation check
+    AuthManager signed_auth(&database);
+    signed_auth.enable_signed_tokens("bench:0123456789abcdef0123456789abcdef");
+    auto signed_tokens = login_all(signed_auth, token_count);
+    run("signed (HMAC verify)", signed_auth, signed_tokens, iterations);
+
+    // Revoked tokens must be rejected
+    for (size_t i = 0; i < signed_tokens.size(); i += 2) {
+        signed_auth.logout(signed_tokens[i]);
+    }
+    run("signed, half revoked", signed_auth, signed_tokens, iterations);
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "AllocationStats.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Trivially initialized, so operator new can touch it on any thread
+// without allocating
+thread_local AllocationStats::Counts t_counts;
+
+} // namespace
+
+namespace AllocationStats {
+
+Counts thread_counts() {
+    return t_counts;
+}
+
+} // namespace AllocationStats
+
+// The aligned forms are left to the library: nothing here over-aligns, and
+// they have their own matching deletes
+void* operator new(std::size_t size) {
+    ++t_counts.allocations;
+    t_counts.bytes += size;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++t_counts.allocations;
+    t_counts.bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
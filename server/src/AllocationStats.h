@@ -0,0 +1,28 @@
+#ifndef ALLOCATION_STATS_H
+#define ALLOCATION_STATS_H
+
+#include <cstdint>
+
+// Heap allocations made through global operator new by the calling
+// thread. Counted only in builds configured with -DCOUNT_ALLOCATIONS=ON,
+// which link AllocationStats.cpp into event_server: it replaces operator
+// new / delete with counting wrappers around malloc / free. Elsewhere the
+// counters stay at zero and enabled() is false.
+namespace AllocationStats {
+
+struct Counts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+#ifdef COUNT_ALLOCATIONS
+inline bool enabled() { return true; }
+Counts thread_counts();
+#else
+inline bool enabled() { return false; }
+inline Counts thread_counts() { return {}; }
+#endif
+
+} // namespace AllocationStats
+
+#endif // ALLOCATION_STATS_H
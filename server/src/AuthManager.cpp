@@ -4,19 +4,48 @@
 #include <sstream>
 #include <iostream>
 
-AuthManager::AuthManager(Database* database) : m_database(database) {
+namespace {
+// How long last_login timestamps may sit in memory before being written,
+// and how long another server's logout may take to reach this one
+const auto kLastLoginFlushInterval = std::chrono::seconds(5);
+} // namespace
+
+AuthManager::AuthManager(Database* database, const Clock& clock)
+    : m_database(database), m_clock(clock), m_flush_running(true) {
+    // Warm the user directory so logins and registrations don't read SQLite
+    m_directory.load(m_database->get_all_users());
+    std::cout << "User directory loaded: " << m_directory.size() << " users" << std::endl;
+    
+    m_revoked_signatures = m_database->get_revoked_tokens();
+    
+    m_flush_thread = std::thread([this]() {
+        flushLoop();
+    });
 }
 
 AuthManager::~AuthManager() {
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_flush_running = false;
+    }
+    m_flush_cv.notify_all();
+    if (m_flush_thread.joinable()) {
+        m_flush_thread.join();
+    }
+    flush_last_logins();
     cleanup_expired_tokens();
 }
 
 AuthToken AuthManager::login(const std::string& username, const std::string& password) {
-    // Get user from database
+    // Credentials are read from SQLite, once per login: another server on the
+    // same database may have registered this user or changed its password or
+    // is_active flag since the directory last saw it. The fresh row replaces
+    // the directory's copy for the token lookups that follow.
     User user = m_database->get_user_by_username(username);
-    if (user.id == 0) {
+    if (user.id <= 0) {
         return AuthToken{}; // User not found
     }
+    m_directory.add(user);
     
     // Verify password
     if (!user.verify_password(password)) {
@@ -28,13 +57,17 @@ AuthToken AuthManager::login(const std::string& username, const std::string& pas
         return AuthToken{}; // User account disabled
     }
     
-    // Update last login
-    user.last_login = std::chrono::system_clock::now();
-    m_database->update_user_last_login(user.id);
+    // Update last login in memory; the database write happens in flushLoop()
+    user.last_login = m_clock.now();
+    m_directory.set_last_login(user.id, user.last_login);
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_pending_last_login[user.id] = user.last_login;
+    }
     
-    // Generate and store auth token
+    // Generate auth token; only opaque tokens need server-side state
     AuthToken token = create_auth_token(user.id);
-    {
+    if (!TokenSigner::looks_signed(token.token)) {
         std::lock_guard<std::mutex> lock(m_tokens_mutex);
         m_active_tokens[token.token] = token;
     }
@@ -61,7 +94,9 @@ bool AuthManager::register_user(const std::string& username, const std::string&
         return false;
     }
     
-    // Check if username or email already exists
+    // Check if username or email already exists (in-memory, no SQLite reads).
+    // Names taken on another server since startup get past this check and
+    // are rejected by the insert instead.
     if (user_exists(username)) {
         std::cerr << "Username already exists: " << username << std::endl;
         return false;
@@ -76,9 +111,12 @@ bool AuthManager::register_user(const std::string& username, const std::string&
     std::string password_hash = User::hash_password(password);
     User user(username, email, password_hash, display_name);
     
-    // Save to database
+    // Save to database - a single INSERT; the UNIQUE constraints on username
+    // and email reject anything that slipped past the directory check
     int user_id = m_database->create_user(user);
     if (user_id > 0) {
+        user.id = user_id;
+        m_directory.add(user);
         std::cout << "User registered: " << username << " (ID: " << user_id << ")" << std::endl;
         return true;
     }
@@ -86,7 +124,20 @@ bool AuthManager::register_user(const std::string& username, const std::string&
     return false;
 }
 
+bool AuthManager::enable_signed_tokens(const std::string& key_spec) {
+    std::lock_guard<std::mutex> lock(m_tokens_mutex);
+    return m_signer.load_keys(key_spec) > 0;
+}
+
 bool AuthManager::logout(const std::string& token) {
+    if (TokenSigner::looks_signed(token)) {
+        TokenSigner::Claims claims;
+        if (!check_signed_token(token, claims)) return false;
+        revoke_signed_token(claims);
+        std::cout << "User logged out (ID: " << claims.user_id << ")" << std::endl;
+        return true;
+    }
+    
     std::lock_guard<std::mutex> lock(m_tokens_mutex);
     auto it = m_active_tokens.find(token);
     if (it != m_active_tokens.end()) {
@@ -98,18 +149,30 @@ bool AuthManager::logout(const std::string& token) {
 }
 
 bool AuthManager::validate_token(const std::string& token) {
+    if (TokenSigner::looks_signed(token)) {
+        TokenSigner::Claims claims;
+        return check_signed_token(token, claims);
+    }
+    
     std::lock_guard<std::mutex> lock(m_tokens_mutex);
     auto it = m_active_tokens.find(token);
     if (it != m_active_tokens.end()) {
-        return it->second.is_valid();
+        return it->second.is_valid(m_clock);
     }
     return false;
 }
 
 AuthToken AuthManager::refresh_token(const std::string& old_token) {
+    if (TokenSigner::looks_signed(old_token)) {
+        TokenSigner::Claims claims;
+        if (!check_signed_token(old_token, claims)) return AuthToken{};
+        revoke_signed_token(claims);
+        return create_auth_token(claims.user_id);
+    }
+    
     std::lock_guard<std::mutex> lock(m_tokens_mutex);
     auto it = m_active_tokens.find(old_token);
-    if (it != m_active_tokens.end() && it->second.is_valid()) {
+    if (it != m_active_tokens.end() && it->second.is_valid(m_clock)) {
         // Create new token for same user
         AuthToken new_token = create_auth_token(it->second.user_id);
         m_active_tokens.erase(it); // Remove old token
@@ -122,48 +185,115 @@ AuthToken AuthManager::refresh_token(const std::string& old_token) {
 User AuthManager::get_user_by_token(const std::string& token) {
     int user_id = get_user_id_by_token(token);
     if (user_id > 0) {
-        return m_database->get_user_by_id(user_id);
+        return get_user_by_id(user_id);
     }
     return User{};
 }
 
 int AuthManager::get_user_id_by_token(const std::string& token) {
+    if (TokenSigner::looks_signed(token)) {
+        TokenSigner::Claims claims;
+        return check_signed_token(token, claims) ? claims.user_id : 0;
+    }
+    
     std::lock_guard<std::mutex> lock(m_tokens_mutex);
     auto it = m_active_tokens.find(token);
-    if (it != m_active_tokens.end() && it->second.is_valid()) {
+    if (it != m_active_tokens.end() && it->second.is_valid(m_clock)) {
         return it->second.user_id;
     }
     return 0;
 }
 
 bool AuthManager::user_exists(const std::string& username) {
-    User user = m_database->get_user_by_username(username);
-    return user.id > 0;
+    return m_directory.username_exists(username);
 }
 
 bool AuthManager::email_exists(const std::string& email) {
-    User user = m_database->get_user_by_email(email);
-    return user.id > 0;
+    return m_directory.email_exists(email);
 }
 
+// A directory miss may be a user registered by another server; one read
+// fetches it and the directory keeps it from then on
 User AuthManager::get_user_by_id(int user_id) {
-    return m_database->get_user_by_id(user_id);
+    UserRecord record;
+    if (m_directory.find_by_id(user_id, record)) {
+        return record.to_user();
+    }
+    User user = m_database->get_user_by_id(user_id);
+    if (user.id > 0) {
+        m_directory.add(user);
+    }
+    return user;
 }
 
 User AuthManager::get_user_by_username(const std::string& username) {
-    return m_database->get_user_by_username(username);
+    UserRecord record;
+    if (m_directory.find_by_username(username, record)) {
+        return record.to_user();
+    }
+    User user = m_database->get_user_by_username(username);
+    if (user.id > 0) {
+        m_directory.add(user);
+    }
+    return user;
 }
 
 void AuthManager::cleanup_expired_tokens() {
     std::lock_guard<std::mutex> lock(m_tokens_mutex);
     auto it = m_active_tokens.begin();
     while (it != m_active_tokens.end()) {
-        if (!it->second.is_valid()) {
+        if (!it->second.is_valid(m_clock)) {
             it = m_active_tokens.erase(it);
         } else {
             ++it;
         }
     }
+    
+    // Expired signed tokens fail validation anyway, so their revocations can go
+    auto now = m_clock.now();
+    auto revoked = m_revoked_signatures.begin();
+    while (revoked != m_revoked_signatures.end()) {
+        if (revoked->second <= now) {
+            revoked = m_revoked_signatures.erase(revoked);
+        } else {
+            ++revoked;
+        }
+    }
+    m_database->delete_expired_revoked_tokens();
+}
+
+void AuthManager::flush_last_logins() {
+    std::unordered_map<int, std::chrono::system_clock::time_point> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        batch.swap(m_pending_last_login);
+    }
+    
+    if (batch.empty()) return;
+    
+    if (!m_database->update_users_last_login(batch)) {
+        // Put the batch back unless a newer login already superseded it
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        for (const auto& entry : batch) {
+            m_pending_last_login.emplace(entry.first, entry.second);
+        }
+        std::cerr << "Failed to flush " << batch.size() << " last_login updates" << std::endl;
+    }
+}
+
+void AuthManager::flushLoop() {
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+    while (m_flush_running) {
+        m_flush_cv.wait_for(lock, kLastLoginFlushInterval, [this]() {
+            return !m_flush_running;
+        });
+        if (!m_flush_running) break;
+        
+        lock.unlock();
+        flush_last_logins();
+        reload_revoked_tokens();
+        lock.lock();
+    }
 }
 
 std::string AuthManager::generate_token() {
@@ -182,12 +312,39 @@ std::string AuthManager::generate_token() {
 
 AuthToken AuthManager::create_auth_token(int user_id) {
     AuthToken token;
-    token.token = generate_token();
     token.user_id = user_id;
-    token.expires_at = std::chrono::system_clock::now() + std::chrono::hours(24); // 24 hour expiry
+    token.expires_at = m_clock.now() + std::chrono::hours(24); // 24 hour expiry
+    token.token = m_signer.enabled() ? m_signer.sign(user_id, token.expires_at) : generate_token();
     return token;
 }
 
+bool AuthManager::check_signed_token(const std::string& token, TokenSigner::Claims& claims) {
+    // Signature and expiry need no shared state; only the revocation list does
+    if (!m_signer.verify(token, claims)) return false;
+    if (m_clock.now() >= claims.expires_at) return false;
+    
+    std::lock_guard<std::mutex> lock(m_tokens_mutex);
+    return m_revoked_signatures.count(claims.signature) == 0;
+}
+
+void AuthManager::revoke_signed_token(const TokenSigner::Claims& claims) {
+    {
+        std::lock_guard<std::mutex> lock(m_tokens_mutex);
+        m_revoked_signatures[claims.signature] = claims.expires_at;
+    }
+    m_database->add_revoked_token(claims.signature, claims.expires_at);
+}
+
+void AuthManager::reload_revoked_tokens() {
+    // Other processes sharing the database revoke tokens too. Merge rather
+    // than replace, so a revocation whose write failed still holds here.
+    auto revoked = m_database->get_revoked_tokens();
+    std::lock_guard<std::mutex> lock(m_tokens_mutex);
+    for (auto& entry : revoked) {
+        m_revoked_signatures.emplace(entry.first, entry.second);
+    }
+}
+
 void AuthManager::remove_token(const std::string& token) {
     std::lock_guard<std::mutex> lock(m_tokens_mutex);
     m_active_tokens.erase(token);
@@ -6,12 +6,19 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
 #include "User.h"
 #include "Database.h"
+#include "UserDirectory.h"
+#include "TokenSigner.h"
 
 class AuthManager {
 public:
-    explicit AuthManager(Database* database);
+    // `clock` decides token expiry and last_login times; it must outlive this
+    explicit AuthManager(Database* database, const Clock& clock = Clock::system());
     ~AuthManager();
     
     // Authentication operations
@@ -20,6 +27,10 @@ public:
                       const std::string& password, const std::string& display_name = "");
     bool logout(const std::string& token);
     
+    // Switch to stateless HMAC-signed tokens ("kid:secret[,kid:secret...]",
+    // first key signs). Call before serving; opaque tokens keep working.
+    bool enable_signed_tokens(const std::string& key_spec);
+    
     // Token management
     bool validate_token(const std::string& token);
     AuthToken refresh_token(const std::string& old_token);
@@ -35,13 +46,35 @@ public:
     // Session cleanup
     void cleanup_expired_tokens();
     
+    // Write any buffered last_login timestamps to the database now
+    void flush_last_logins();
+    
 private:
     Database* m_database;
+    const Clock& m_clock;
+    UserDirectory m_directory;
     std::unordered_map<std::string, AuthToken> m_active_tokens;
     std::mutex m_tokens_mutex;
     
+    // Signed token support; revoked signatures are kept until they expire and
+    // re-read from the database by m_flush_thread
+    TokenSigner m_signer;
+    std::unordered_map<std::string, std::chrono::system_clock::time_point> m_revoked_signatures;
+    
+    // Write-behind buffer for last_login updates, flushed by m_flush_thread
+    std::unordered_map<int, std::chrono::system_clock::time_point> m_pending_last_login;
+    std::mutex m_pending_mutex;
+    std::condition_variable m_flush_cv;
+    std::atomic<bool> m_flush_running;
+    std::thread m_flush_thread;
+    
+    void flushLoop();
+    
     std::string generate_token();
     AuthToken create_auth_token(int user_id);
+    bool check_signed_token(const std::string& token, TokenSigner::Claims& claims);
+    void revoke_signed_token(const TokenSigner::Claims& claims);
+    void reload_revoked_tokens();
     void remove_token(const std::string& token);
 };
 
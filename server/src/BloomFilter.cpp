@@ -0,0 +1,56 @@
+#include "BloomFilter.h"
+#include <algorithm>
+#include <cmath>
+
+BloomFilter::BloomFilter(size_t expected_items, double false_positive_rate)
+    : m_expected_items(std::max<size_t>(expected_items, 1)), m_count(0) {
+    // Optimal sizing: m = -n ln(p) / ln(2)^2, k = (m / n) ln(2)
+    const double ln2 = std::log(2.0);
+    double bits = -static_cast<double>(m_expected_items) * std::log(false_positive_rate) / (ln2 * ln2);
+    m_bit_count = std::max<size_t>(64, static_cast<size_t>(std::ceil(bits)));
+    m_hash_count = std::max<size_t>(1, static_cast<size_t>(
+        std::round(static_cast<double>(m_bit_count) / m_expected_items * ln2)));
+    m_bits.assign((m_bit_count + 63) / 64, 0);
+}
+
+void BloomFilter::insert(const std::string& key) {
+    uint64_t h1, h2;
+    hash_pair(key, h1, h2);
+    for (size_t i = 0; i < m_hash_count; ++i) {
+        size_t bit = static_cast<size_t>((h1 + i * h2) % m_bit_count);
+        m_bits[bit / 64] |= (uint64_t(1) << (bit % 64));
+    }
+    ++m_count;
+}
+
+bool BloomFilter::might_contain(const std::string& key) const {
+    uint64_t h1, h2;
+    hash_pair(key, h1, h2);
+    for (size_t i = 0; i < m_hash_count; ++i) {
+        size_t bit = static_cast<size_t>((h1 + i * h2) % m_bit_count);
+        if ((m_bits[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BloomFilter::clear() {
+    std::fill(m_bits.begin(), m_bits.end(), 0);
+    m_count = 0;
+}
+
+void BloomFilter::hash_pair(const std::string& key, uint64_t& h1, uint64_t& h2) const {
+    // Double hashing (Kirsch-Mitzenmacher) from a single 64-bit FNV-1a pass
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    h1 = hash;
+    // splitmix64 finalizer gives an independent-enough second hash
+    uint64_t z = hash + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    h2 = (z ^ (z >> 31)) | 1; // odd step so all probes are distinct
+}
@@ -0,0 +1,32 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Probabilistic set membership: might_contain() never returns false for an
+// inserted key, so a negative answer lets callers skip the authoritative lookup.
+class BloomFilter {
+public:
+    BloomFilter(size_t expected_items = 1024, double false_positive_rate = 0.01);
+
+    void insert(const std::string& key);
+    bool might_contain(const std::string& key) const;
+    void clear();
+
+    size_t size() const { return m_count; }
+    size_t capacity() const { return m_expected_items; }
+
+private:
+    void hash_pair(const std::string& key, uint64_t& h1, uint64_t& h2) const;
+
+    std::vector<uint64_t> m_bits;
+    size_t m_bit_count;
+    size_t m_hash_count;
+    size_t m_expected_items;
+    size_t m_count;
+};
+
+#endif // BLOOM_FILTER_H
@@ -0,0 +1,374 @@
+#include "BulkIO.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+enum Field {
+    FieldId,
+    FieldUserId,
+    FieldTitle,
+    FieldDescription,
+    FieldEventTime,
+    FieldReminderTime,
+    FieldCreator,
+    FieldReminderSent,
+    FieldCreatedAt,
+    FieldCount,
+    FieldUnknown = FieldCount
+};
+
+// Column names, in the order csv_header() writes them
+const char* const kFieldNames[FieldCount] = {
+    "id", "user_id", "title", "description", "event_time",
+    "reminder_time", "creator", "reminder_sent", "created_at"
+};
+
+int64_t to_ms(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_ms(int64_t ms) {
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+}
+
+bool parse_int64(const std::string& text, int64_t& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    long long parsed = std::strtoll(text.c_str(), &end, 10);
+    if (*end != '\0') return false;
+    value = parsed;
+    return true;
+}
+
+bool parse_bool(const std::string& text, bool& value) {
+    if (text == "1" || text == "true") {
+        value = true;
+    } else if (text == "0" || text == "false" || text.empty()) {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Splits one CSV record; handles quoted fields with "" escapes
+bool split_csv(std::string_view line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"') {
+                if (i + 1 < line.size() && line[i + 1] == '"') {
+                    field += '"';
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                field += c;
+            }
+        } else if (c == '"' && field.empty()) {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+
+    if (quoted) return false;
+    fields.push_back(std::move(field));
+    return true;
+}
+
+void append_csv_field(std::string& out, const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out += value;
+        return;
+    }
+    out += '"';
+    for (char c : value) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+bool is_blank(std::string_view line) {
+    return std::all_of(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); });
+}
+
+// Fills in the optional fields the record did not supply
+void apply_defaults(Event& event, bool has_reminder_time, bool has_created_at) {
+    if (!has_reminder_time) {
+        event.reminder_time = event.event_time - std::chrono::hours(1);
+    }
+    if (!has_created_at) {
+        event.created_at = std::chrono::system_clock::now();
+    }
+}
+
+} // namespace
+
+namespace BulkIO {
+
+bool parse_format(const std::string& name, BulkFormat& format) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (lower == "ndjson" || lower == "jsonl" || lower == "json") {
+        format = BulkFormat::NDJSON;
+    } else if (lower == "csv") {
+        format = BulkFormat::CSV;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+BulkFormat format_for_path(const std::string& path) {
+    auto dot = path.rfind('.');
+    BulkFormat format = BulkFormat::NDJSON;
+    if (dot != std::string::npos) {
+        parse_format(path.substr(dot + 1), format);
+    }
+    return format;
+}
+
+std::string csv_header() {
+    std::string header;
+    for (int i = 0; i < FieldCount; ++i) {
+        if (i > 0) header += ',';
+        header += kFieldNames[i];
+    }
+    return header;
+}
+
+std::string to_csv(const Event& event) {
+    std::string line;
+    line.reserve(64 + event.title.size() + event.description.size() + event.creator.size());
+
+    line += std::to_string(event.id);
+    line += ',';
+    line += std::to_string(event.user_id);
+    line += ',';
+    append_csv_field(line, event.title);
+    line += ',';
+    append_csv_field(line, event.description);
+    line += ',';
+    line += std::to_string(to_ms(event.event_time));
+    line += ',';
+    line += std::to_string(to_ms(event.reminder_time));
+    line += ',';
+    append_csv_field(line, event.creator);
+    line += ',';
+    line += event.reminder_sent ? '1' : '0';
+    line += ',';
+    line += std::to_string(to_ms(event.created_at));
+    return line;
+}
+
+std::string to_ndjson(const Event& event) {
+    return event.to_json().dump();
+}
+
+EventReader::EventReader(BulkFormat format)
+    : m_format(format), m_header_read(false) {
+}
+
+bool EventReader::parse_line(std::string_view line, Event& event, bool& has_event, std::string& error) {
+    has_event = false;
+    if (is_blank(line)) {
+        return true;
+    }
+
+    if (m_format == BulkFormat::CSV && !m_header_read) {
+        return parse_csv_header(line, error);
+    }
+
+    event = Event();
+    bool parsed = m_format == BulkFormat::CSV ? parse_csv_record(line, event, error)
+                                              : parse_json_record(line, event, error);
+    has_event = parsed;
+    return parsed;
+}
+
+bool EventReader::parse_csv_header(std::string_view line, std::string& error) {
+    std::vector<std::string> names;
+    if (!split_csv(line, names)) {
+        error = "unterminated quote in CSV header";
+        return false;
+    }
+
+    bool has_title = false;
+    bool has_event_time = false;
+    m_columns.clear();
+    for (const auto& name : names) {
+        int field = FieldUnknown;
+        for (int i = 0; i < FieldCount; ++i) {
+            if (name == kFieldNames[i]) {
+                field = i;
+                break;
+            }
+        }
+        has_title = has_title || field == FieldTitle;
+        has_event_time = has_event_time || field == FieldEventTime;
+        m_columns.push_back(field);
+    }
+
+    if (!has_title || !has_event_time) {
+        error = "CSV header must name at least title and event_time";
+        return false;
+    }
+
+    m_header_read = true;
+    return true;
+}
+
+bool EventReader::parse_csv_record(std::string_view line, Event& event, std::string& error) {
+    std::vector<std::string> values;
+    if (!split_csv(line, values)) {
+        error = "unterminated quote";
+        return false;
+    }
+    if (values.size() != m_columns.size()) {
+        error = "expected " + std::to_string(m_columns.size()) + " columns, got " +
+                std::to_string(values.size());
+        return false;
+    }
+
+    bool has_reminder_time = false;
+    bool has_created_at = false;
+    for (size_t i = 0; i < values.size(); ++i) {
+        const std::string& value = values[i];
+        int64_t number = 0;
+
+        switch (m_columns[i]) {
+        case FieldUserId:
+            if (!parse_int64(value, number)) {
+                error = "invalid user_id";
+                return false;
+            }
+            event.user_id = static_cast<int>(number);
+            break;
+        case FieldTitle:
+            event.title = value;
+            break;
+        case FieldDescription:
+            event.description = value;
+            break;
+        case FieldEventTime:
+            if (!parse_int64(value, number)) {
+                error = "invalid event_time";
+                return false;
+            }
+            event.event_time = from_ms(number);
+            break;
+        case FieldReminderTime:
+            if (value.empty()) break;
+            if (!parse_int64(value, number)) {
+                error = "invalid reminder_time";
+                return false;
+            }
+            event.reminder_time = from_ms(number);
+            has_reminder_time = true;
+            break;
+        case FieldCreator:
+            event.creator = value;
+            break;
+        case FieldReminderSent:
+            if (!parse_bool(value, event.reminder_sent)) {
+                error = "invalid reminder_sent";
+                return false;
+            }
+            break;
+        case FieldCreatedAt:
+            if (value.empty()) break;
+            if (!parse_int64(value, number)) {
+                error = "invalid created_at";
+                return false;
+            }
+            event.created_at = from_ms(number);
+            has_created_at = true;
+            break;
+        default:
+            // id and unknown columns are ignored
+            break;
+        }
+    }
+
+    if (event.title.empty()) {
+        error = "missing title";
+        return false;
+    }
+
+    apply_defaults(event, has_reminder_time, has_created_at);
+    return true;
+}
+
+bool EventReader::parse_json_record(std::string_view line, Event& event, std::string& error) {
+    nlohmann::json record = nlohmann::json::parse(line, nullptr, false);
+    if (record.is_discarded() || !record.is_object()) {
+        error = "not a JSON object";
+        return false;
+    }
+
+    auto title = record.find("title");
+    auto event_time = record.find("event_time");
+    if (title == record.end() || !title->is_string() || title->get_ref<const std::string&>().empty()) {
+        error = "missing title";
+        return false;
+    }
+    if (event_time == record.end() || !event_time->is_number_integer()) {
+        error = "missing or invalid event_time";
+        return false;
+    }
+
+    event.title = title->get<std::string>();
+    event.event_time = from_ms(event_time->get<int64_t>());
+
+    auto user_id = record.find("user_id");
+    if (user_id != record.end() && user_id->is_number_integer()) {
+        event.user_id = user_id->get<int>();
+    }
+    auto description = record.find("description");
+    if (description != record.end() && description->is_string()) {
+        event.description = description->get<std::string>();
+    }
+    auto creator = record.find("creator");
+    if (creator != record.end() && creator->is_string()) {
+        event.creator = creator->get<std::string>();
+    }
+    auto reminder_sent = record.find("reminder_sent");
+    if (reminder_sent != record.end() && reminder_sent->is_boolean()) {
+        event.reminder_sent = reminder_sent->get<bool>();
+    }
+    // A bad rule rejects the line rather than importing a single event
+    auto recurrence = record.find("recurrence");
+    if (recurrence != record.end() && !Recurrence::from_json(*recurrence, event.recurrence, error)) {
+        return false;
+    }
+
+    auto reminder_time = record.find("reminder_time");
+    bool has_reminder_time = reminder_time != record.end() && reminder_time->is_number_integer();
+    if (has_reminder_time) {
+        event.reminder_time = from_ms(reminder_time->get<int64_t>());
+    }
+    auto created_at = record.find("created_at");
+    bool has_created_at = created_at != record.end() && created_at->is_number_integer();
+    if (has_created_at) {
+        event.created_at = from_ms(created_at->get<int64_t>());
+    }
+
+    apply_defaults(event, has_reminder_time, has_created_at);
+    return true;
+}
+
+} // namespace BulkIO
@@ -0,0 +1,56 @@
+#ifndef BULK_IO_H
+#define BULK_IO_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Event.h"
+
+// Line-oriented event formats used by event_admin and event_bulk_import.
+// Both carry the same fields as Event::to_json, except that only NDJSON has
+// the recurrence rule; times are epoch milliseconds.
+//   NDJSON: one JSON object per line
+//   CSV:    header line naming the columns, then one event per line
+//           (RFC 4180 quoting; fields may not contain line breaks)
+enum class BulkFormat {
+    NDJSON,
+    CSV
+};
+
+namespace BulkIO {
+    bool parse_format(const std::string& name, BulkFormat& format);
+
+    // Guesses from the file extension (".csv" -> CSV, anything else NDJSON)
+    BulkFormat format_for_path(const std::string& path);
+
+    // Writers - return one line without the trailing newline
+    std::string csv_header();
+    std::string to_csv(const Event& event);
+    std::string to_ndjson(const Event& event);
+
+    // Parses one input line at a time. Only title and event_time are
+    // required; id is ignored (imports always get new ids), reminder_time
+    // defaults to an hour before the event and created_at to now.
+    class EventReader {
+    public:
+        explicit EventReader(BulkFormat format);
+
+        // Returns false with `error` set for a malformed line. Blank lines
+        // and the CSV header return true with has_event == false.
+        bool parse_line(std::string_view line, Event& event, bool& has_event, std::string& error);
+
+        // True until a CSV reader has seen a valid header
+        bool needs_header() const { return m_format == BulkFormat::CSV && !m_header_read; }
+
+    private:
+        bool parse_csv_header(std::string_view line, std::string& error);
+        bool parse_csv_record(std::string_view line, Event& event, std::string& error);
+        bool parse_json_record(std::string_view line, Event& event, std::string& error);
+
+        BulkFormat m_format;
+        bool m_header_read;
+        std::vector<int> m_columns;   // CSV column index -> field id
+    };
+}
+
+#endif // BULK_IO_H
@@ -1,27 +1,140 @@
 #include "Database.h"
+#include "RowCodec.h"
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <future>
 
-Database::Database(const std::string& db_path) : m_db(nullptr), m_db_path(db_path) {
-    initialize();
-}
+namespace {
+struct StatementDefinition {
+    const char* name;
+    const char* sql;
+};
 
-Database::~Database() {
-    if (m_db) {
-        sqlite3_close(m_db);
-    }
-}
+// Indexed by Database::StatementId
+const StatementDefinition kStatements[] = {
+    {"insert_event", R"(
+        INSERT INTO events (user_id, title, description, event_time, reminder_time, creator, reminder_sent, created_at,
+                            recurrence)
+        VALUES (?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?11);
+    )"},
+    {"update_event", R"(
+        UPDATE events 
+        SET title = ?3, description = ?4, event_time = ?5, reminder_time = ?6, 
+            creator = ?7, reminder_sent = ?8, recurrence = ?11
+        WHERE id = ?1
+        RETURNING *;
+    )"},
+    {"delete_event", "DELETE FROM events WHERE id = ?;"},
+    // Ownership, version and "anything to change?" are all part of the
+    // WHERE clause, so a client edit is one statement; ?10 (the client's
+    // version) = 0 skips the version check for clients that don't send one.
+    // ?12 is the caller, the only parameter that isn't an Event column.
+    // The rule's last_reminded is the server's, not the client's: the stored
+    // one is carried over and the client's (stale or missing) is ignored,
+    // also when deciding whether anything changed.
+    {"update_owned_event", R"(
+        UPDATE events
+        SET title = ?3, description = ?4, event_time = ?5, reminder_time = ?6,
+            creator = ?7, reminder_sent = ?8, version = version + 1,
+            recurrence = CASE WHEN json_extract(recurrence, '$.last_reminded') IS NULL
+                              THEN json_remove(?11, '$.last_reminded')
+                              ELSE json_set(?11, '$.last_reminded', json_extract(recurrence, '$.last_reminded'))
+                         END
+        WHERE id = ?1 AND user_id = ?12 AND (?10 = 0 OR version = ?10)
+          AND (title IS NOT ?3 OR description IS NOT ?4 OR event_time IS NOT ?5
+               OR reminder_time IS NOT ?6 OR creator IS NOT ?7 OR reminder_sent IS NOT ?8
+               OR json_remove(recurrence, '$.last_reminded') IS NOT json_remove(?11, '$.last_reminded'))
+        RETURNING *;
+    )"},
+    {"delete_owned_event", R"(
+        DELETE FROM events
+        WHERE id = ?1 AND user_id = ?2 AND (?3 = 0 OR version = ?3)
+        RETURNING id;
+    )"},
+    {"select_all_events", "SELECT * FROM events ORDER BY event_time ASC;"},
+    {"select_event_by_id", "SELECT * FROM events WHERE id = ?;"},
+    {"select_events_needing_reminder", "SELECT * FROM events WHERE reminder_sent = 0 ORDER BY reminder_time ASC;"},
+    // Range on the partial pending-reminders index, so a tick reads only
+    // the due rows however many reminders are still in the future. Rows
+    // whose event has started come back too, for the caller to retire.
+    // Recurring events go through claim_occurrence_reminder instead.
+    {"select_due_reminders", R"(
+        SELECT * FROM events
+        WHERE reminder_sent = 0 AND reminder_time <= ?1 AND recurrence IS NULL
+        ORDER BY reminder_time ASC
+        LIMIT ?2;
+    )"},
+    // ?1 is a JSON array of ids: one prepared statement for any batch size
+    {"mark_reminders_sent", R"(
+        UPDATE events SET reminder_sent = 1
+        WHERE id IN (SELECT value FROM json_each(?1)) AND reminder_sent = 0
+        RETURNING *;
+    )"},
+    // Records the occurrence (?2, ms) whose reminder went out; a second
+    // claim of the same or an earlier occurrence matches nothing
+    {"claim_occurrence_reminder", R"(
+        UPDATE events SET recurrence = json_set(recurrence, '$.last_reminded', ?2)
+        WHERE id = ?1 AND recurrence IS NOT NULL
+          AND coalesce(json_extract(recurrence, '$.last_reminded'), 0) < ?2
+        RETURNING *;
+    )"},
+    // A window [?1, ?2): single events starting in it, and recurring ones
+    // that started before its end (their occurrences are filtered in C++).
+    // Two index ranges rather than one OR, which would read every row
+    // before ?2.
+    {"select_events_between", R"(
+        SELECT * FROM events
+        WHERE event_time >= ?1 AND event_time < ?2 AND recurrence IS NULL
+        UNION ALL
+        SELECT * FROM events
+        WHERE recurrence IS NOT NULL AND event_time < ?2;
+    )"},
+    {"select_events_for_user", "SELECT * FROM events WHERE user_id = ? ORDER BY event_time ASC;"},
+    {"insert_user", R"(
+        INSERT INTO users (username, email, password_hash, display_name, created_at, last_login, is_active)
+        VALUES (?2, ?3, ?4, ?5, ?6, ?7, ?8);
+    )"},
+    {"update_user", R"(
+        UPDATE users 
+        SET username = ?2, email = ?3, password_hash = ?4, display_name = ?5, 
+            last_login = ?7, is_active = ?8
+        WHERE id = ?1;
+    )"},
+    {"update_user_last_login", "UPDATE users SET last_login = ? WHERE id = ?;"},
+    {"select_user_by_id", "SELECT * FROM users WHERE id = ?;"},
+    {"select_user_by_username", "SELECT * FROM users WHERE username = ?;"},
+    {"select_user_by_email", "SELECT * FROM users WHERE email = ?;"},
+    {"select_all_users", "SELECT * FROM users;"},
+    {"delete_user", "DELETE FROM users WHERE id = ?;"},
+    {"insert_revoked_token", "INSERT OR REPLACE INTO revoked_tokens (signature, expires_at) VALUES (?, ?);"},
+    {"select_revoked_tokens", "SELECT signature, expires_at FROM revoked_tokens;"},
+    {"delete_expired_revoked_tokens", "DELETE FROM revoked_tokens WHERE expires_at <= ?;"},
+    {"begin", "BEGIN IMMEDIATE;"},
+    {"commit", "COMMIT;"},
+    {"rollback", "ROLLBACK;"},
+    {"savepoint", "SAVEPOINT write_task;"},
+    {"release_savepoint", "RELEASE write_task;"},
+    {"rollback_to_savepoint", "ROLLBACK TO write_task;"},
+};
 
-bool Database::initialize() {
-    int rc = sqlite3_open(m_db_path.c_str(), &m_db);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "Cannot open database: " << sqlite3_errmsg(m_db) << std::endl;
-        return false;
-    }
-    
-    // Create users table
-    const std::string create_users_table = R"(
+static_assert(sizeof(kStatements) / sizeof(kStatements[0]) == Database::StmtCount,
+              "kStatements must have one entry per Database::StatementId");
+
+struct Migration {
+    int version;
+    const char* description;
+    const char* sql;
+};
+
+// Schema history, applied in order. PRAGMA user_version records the last one
+// applied, so existing deployments pick up new entries in place on startup.
+// Never edit a released entry - append a new one instead.
+const Migration kMigrations[] = {
+    // Databases created before migrations existed already have these tables
+    // and report user_version 0, hence IF NOT EXISTS
+    {1, "users and events tables", R"(
         CREATE TABLE IF NOT EXISTS users (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             username TEXT UNIQUE NOT NULL,
@@ -32,10 +145,6 @@ bool Database::initialize() {
             last_login INTEGER NOT NULL,
             is_active INTEGER DEFAULT 1
         );
-    )";
-    
-    // Create events table with user_id
-    const std::string create_events_table = R"(
         CREATE TABLE IF NOT EXISTS events (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             user_id INTEGER NOT NULL,
@@ -48,460 +157,1641 @@ bool Database::initialize() {
             created_at INTEGER NOT NULL,
             FOREIGN KEY (user_id) REFERENCES users (id)
         );
-    )";
-    
-    return execute_sql(create_users_table) && execute_sql(create_events_table);
+    )"},
+    {2, "revocation list for signed session tokens", R"(
+        CREATE TABLE IF NOT EXISTS revoked_tokens (
+            signature TEXT PRIMARY KEY,
+            expires_at INTEGER NOT NULL
+        );
+    )"},
+    // select_all_events / select_events_for_user walk these in event_time
+    // order instead of sorting; the reminder index only holds unsent rows so
+    // it stays small no matter how many events have already fired
+    {3, "indexes for event listing and reminder polling", R"(
+        CREATE INDEX IF NOT EXISTS idx_events_event_time ON events (event_time);
+        CREATE INDEX IF NOT EXISTS idx_events_user_time ON events (user_id, event_time);
+        CREATE INDEX IF NOT EXISTS idx_events_pending_reminders ON events (reminder_time)
+            WHERE reminder_sent = 0;
+    )"},
+    // Optimistic concurrency for client edits; existing rows start at 1
+    {4, "event version column", R"(
+        ALTER TABLE events ADD COLUMN version INTEGER NOT NULL DEFAULT 1;
+    )"},
+    // Repeat rule as Recurrence JSON; NULL for single events. The partial
+    // index holds only the recurring rows, which a listing window reads
+    // regardless of where it starts.
+    {5, "event recurrence rule", R"(
+        ALTER TABLE events ADD COLUMN recurrence TEXT;
+        CREATE INDEX IF NOT EXISTS idx_events_recurring ON events (event_time)
+            WHERE recurrence IS NOT NULL;
+    )"},
+};
+
+// Statements that run on every request or reminder tick, with the indexes
+// their plans must read through (no full scans, no temporary sorts).
+// "INTEGER PRIMARY KEY" stands for a rowid lookup; sqlite_autoindex_users_1
+// and _2 back the UNIQUE username and email columns.
+struct IndexedStatement {
+    Database::StatementId id;
+    const char* indexes[2];
+};
+
+const IndexedStatement kIndexedStatements[] = {
+    {Database::StmtSelectAllEvents, {"idx_events_event_time"}},
+    {Database::StmtSelectEventById, {"INTEGER PRIMARY KEY"}},
+    {Database::StmtSelectEventsNeedingReminder, {"idx_events_pending_reminders"}},
+    {Database::StmtSelectDueReminders, {"idx_events_pending_reminders"}},
+    {Database::StmtSelectEventsBetween, {"idx_events_event_time", "idx_events_recurring"}},
+    {Database::StmtSelectEventsForUser, {"idx_events_user_time"}},
+    {Database::StmtSelectUserById, {"INTEGER PRIMARY KEY"}},
+    {Database::StmtSelectUserByUsername, {"sqlite_autoindex_users_1"}},
+    {Database::StmtSelectUserByEmail, {"sqlite_autoindex_users_2"}},
+};
+
+// Whether one EXPLAIN QUERY PLAN line reads its table through `index`
+bool plan_uses_index(const std::string& detail, const std::string& index) {
+    for (const char* via : {"USING INDEX ", "USING COVERING INDEX ", "USING "}) {
+        size_t at = detail.find(via + index);
+        size_t end = at + std::strlen(via) + index.size();
+        if (at != std::string::npos && (end == detail.size() || detail[end] == ' ')) {
+            return true;
+        }
+    }
+    return false;
 }
 
-bool Database::execute_sql(const std::string& sql) {
-    char* error_msg = nullptr;
-    int rc = sqlite3_exec(m_db, sql.c_str(), nullptr, nullptr, &error_msg);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << error_msg << std::endl;
-        sqlite3_free(error_msg);
-        return false;
+// Prepared on every reader connection; the writer prepares all statements
+const Database::StatementId kReadStatements[] = {
+    Database::StmtSelectAllEvents,
+    Database::StmtSelectEventById,
+    Database::StmtSelectEventsNeedingReminder,
+    Database::StmtSelectDueReminders,
+    Database::StmtSelectEventsBetween,
+    Database::StmtSelectEventsForUser,
+    Database::StmtSelectUserById,
+    Database::StmtSelectUserByUsername,
+    Database::StmtSelectUserByEmail,
+    Database::StmtSelectAllUsers,
+    Database::StmtSelectRevokedTokens,
+};
+
+bool prepare_statements(sqlite3* db, StatementCache& cache) {
+    // Parse and plan every statement once; methods only bind and step
+    for (size_t i = 0; i < Database::StmtCount; ++i) {
+        if (!cache.prepare(db, i, kStatements[i].name, kStatements[i].sql)) {
+            return false;
+        }
     }
-    
     return true;
 }
+} // namespace
 
-int Database::create_event(const Event& event) {
-    const std::string sql = R"(
-        INSERT INTO events (user_id, title, description, event_time, reminder_time, creator, reminder_sent, created_at)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?);
-    )";
+Database::Database(const std::string& db_path, const DatabaseOptions& options)
+    : m_db_path(db_path), m_options(options), m_wal_enabled(false),
+      m_writer_running(false), m_commit_batches(0), m_committed_writes(0),
+      m_checkpoint_running(false) {
+    if (!initialize()) {
+        return;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        m_writer_running = true;
+    }
+    m_writer_thread = std::thread([this]() {
+        writerLoop();
+    });
+    
+    if (m_wal_enabled && m_options.checkpoint_interval.count() > 0) {
+        m_checkpoint_running = true;
+        m_checkpoint_thread = std::thread([this]() {
+            checkpointLoop();
+        });
+    }
+}
+
+Database::~Database() {
+    {
+        std::lock_guard<std::mutex> lock(m_checkpoint_mutex);
+        m_checkpoint_running = false;
+    }
+    m_checkpoint_cv.notify_all();
+    if (m_checkpoint_thread.joinable()) {
+        m_checkpoint_thread.join();
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(m_db) << std::endl;
-        return -1;
-    }
-    
-    auto event_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        event.event_time.time_since_epoch()).count();
-    auto reminder_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        event.reminder_time.time_since_epoch()).count();
-    auto created_at_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        event.created_at.time_since_epoch()).count();
-    
-    sqlite3_bind_int(stmt, 1, event.user_id);
-    sqlite3_bind_text(stmt, 2, event.title.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, event.description.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 4, event_time_ms);
-    sqlite3_bind_int64(stmt, 5, reminder_time_ms);
-    sqlite3_bind_text(stmt, 6, event.creator.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 7, event.reminder_sent ? 1 : 0);
-    sqlite3_bind_int64(stmt, 8, created_at_ms);
-    
-    rc = sqlite3_step(stmt);
-    int event_id = -1;
+    // The writer drains whatever is still queued before it exits
+    {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        m_writer_running = false;
+    }
+    m_write_cv.notify_all();
+    if (m_writer_thread.joinable()) {
+        m_writer_thread.join();
+    }
     
-    if (rc == SQLITE_DONE) {
-        event_id = static_cast<int>(sqlite3_last_insert_rowid(m_db));
-    } else {
-        std::cerr << "Failed to insert event: " << sqlite3_errmsg(m_db) << std::endl;
+    close_readers();
+    
+    // Fold the WAL back into the main file so the next open starts clean
+    if (m_wal_enabled) {
+        checkpoint(true);
     }
     
-    sqlite3_finalize(stmt);
-    return event_id;
+    // Statements must be finalized before the connection can close
+    m_writer.statements.finalize_all();
+    if (m_writer.db) {
+        sqlite3_close(m_writer.db);
+    }
 }
 
-bool Database::update_event(const Event& event) {
-    const std::string sql = R"(
-        UPDATE events 
-        SET title = ?, description = ?, event_time = ?, reminder_time = ?, 
-            creator = ?, reminder_sent = ?
-        WHERE id = ?;
-    )";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+bool Database::initialize() {
+    int rc = sqlite3_open_v2(m_db_path.c_str(), &m_writer.db,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr);
     
     if (rc != SQLITE_OK) {
-        std::cerr << "Failed to prepare update statement: " << sqlite3_errmsg(m_db) << std::endl;
+        std::cerr << "Cannot open database: " << sqlite3_errmsg(m_writer.db) << std::endl;
         return false;
     }
     
-    auto event_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        event.event_time.time_since_epoch()).count();
-    auto reminder_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        event.reminder_time.time_since_epoch()).count();
-    
-    sqlite3_bind_text(stmt, 1, event.title.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, event.description.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 3, event_time_ms);
-    sqlite3_bind_int64(stmt, 4, reminder_time_ms);
-    sqlite3_bind_text(stmt, 5, event.creator.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 6, event.reminder_sent ? 1 : 0);
-    sqlite3_bind_int(stmt, 7, event.id);
+    if (!apply_options(m_writer.db, true)) {
+        return false;
+    }
     
-    rc = sqlite3_step(stmt);
-    bool success = (rc == SQLITE_DONE);
+    if (!migrate()) {
+        return false;
+    }
     
-    sqlite3_finalize(stmt);
-    return success;
-}
-
-bool Database::delete_event(int event_id) {
-    const std::string sql = "DELETE FROM events WHERE id = ?;";
+    if (!prepare_statements(m_writer.db, m_writer.statements)) {
+        return false;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    verify_query_plans();
     
-    if (rc != SQLITE_OK) {
+    if (m_options.cache_events && !load_events()) {
         return false;
     }
     
-    sqlite3_bind_int(stmt, 1, event_id);
-    rc = sqlite3_step(stmt);
-    bool success = (rc == SQLITE_DONE);
-    
-    sqlite3_finalize(stmt);
-    return success;
+    // Readers need the schema in place to prepare their statements
+    return open_readers();
 }
 
-std::vector<Event> Database::get_all_events() {
-    std::vector<Event> events;
-    const std::string sql = "SELECT * FROM events ORDER BY event_time ASC;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+bool Database::load_events() {
+    auto start = std::chrono::steady_clock::now();
+    
+    // Published in chunks so a large table never exists twice in memory
+    const size_t kChunk = 65536;
+    std::vector<std::pair<int, EventPtr>> chunk;
+    chunk.reserve(kChunk);
+    size_t count = 0;
+    
+    m_events.clear();
+    {
+        auto stmt = m_writer.statements.acquire(StmtSelectAllEvents);
+        if (!stmt) {
+            return false;
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto event = std::make_shared<const Event>(event_from_row(stmt));
+            int id = event->id;
+            chunk.emplace_back(id, std::move(event));
+            if (chunk.size() == kChunk) {
+                m_events.publish(chunk);
+                count += chunk.size();
+                chunk.clear();
+            }
+        }
+    }
+    m_events.publish(chunk);
+    count += chunk.size();
     
-    if (rc != SQLITE_OK) {
-        return events;
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Loaded " << count << " events into memory in " << elapsed_ms << " ms" << std::endl;
+    return true;
+}
+
+// Recorded even without cache_events, for the change listener
+void Database::record_event(EventPtr event) {
+    int id = event->id;
+    m_pending_events.emplace_back(id, std::move(event));
+}
+
+void Database::record_event_erased(int event_id) {
+    m_pending_events.emplace_back(event_id, nullptr);
+}
+
+void Database::set_change_listener(ChangeListener listener) {
+    std::lock_guard<std::mutex> lock(m_listener_mutex);
+    m_change_listener = std::move(listener);
+}
+
+bool Database::open_readers() {
+    // Without WAL a reader would block on (and block) the writer, and a
+    // :memory: database is private to its connection
+    if (!m_wal_enabled || m_options.reader_connections <= 0) {
+        return true;
     }
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        events.push_back(event_from_row(stmt));
+    for (int i = 0; i < m_options.reader_connections; ++i) {
+        auto reader = std::make_unique<Connection>();
+        int rc = sqlite3_open_v2(m_db_path.c_str(), &reader->db,
+                                 SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+        if (rc != SQLITE_OK) {
+            std::cerr << "Cannot open reader connection: " << sqlite3_errmsg(reader->db) << std::endl;
+            sqlite3_close(reader->db);
+            return false;
+        }
+        
+        bool prepared = apply_options(reader->db, false);
+        for (StatementId id : kReadStatements) {
+            prepared = prepared && reader->statements.prepare(reader->db, id, kStatements[id].name,
+                                                              kStatements[id].sql);
+        }
+        if (!prepared) {
+            reader->statements.finalize_all();
+            sqlite3_close(reader->db);
+            return false;
+        }
+        
+        m_idle_readers.push_back(reader.get());
+        m_readers.push_back(std::move(reader));
     }
     
-    sqlite3_finalize(stmt);
-    return events;
+    std::cout << "Database reader connections: " << m_readers.size() << std::endl;
+    return true;
 }
 
-//adding get_event_by_id method to this file
+void Database::close_readers() {
+    std::lock_guard<std::mutex> lock(m_reader_mutex);
+    for (auto& reader : m_readers) {
+        reader->statements.finalize_all();
+        sqlite3_close(reader->db);
+    }
+    m_idle_readers.clear();
+    m_readers.clear();
+}
 
-// Add this function to your Database.cpp file
+void Database::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_write_mutex);
+    m_writer_thread_id = std::this_thread::get_id();
+    
+    const size_t max_batch = static_cast<size_t>(std::max(1, m_options.group_commit_max_batch));
+    size_t last_batch_size = 0;
+    std::vector<PendingWrite> batch;
+    
+    while (true) {
+        m_write_cv.wait(lock, [this]() {
+            return !m_write_queue.empty() || !m_writer_running;
+        });
+        if (m_write_queue.empty()) break;
+        
+        // Only hold the window open during a burst, and only while writes keep
+        // arriving: a single caller writing one event at a time never pays the
+        // delay, and a fixed set of blocked callers commits as soon as all of
+        // them have queued
+        bool burst = m_write_queue.size() > 1 || last_batch_size > 1;
+        if (burst && m_options.group_commit_max_delay.count() > 0) {
+            auto deadline = std::chrono::steady_clock::now() + m_options.group_commit_max_delay;
+            auto quiet_gap = m_options.group_commit_max_delay / 8;
+            size_t seen = m_write_queue.size();
+            
+            while (seen < max_batch && m_writer_running) {
+                auto until = std::min(deadline, std::chrono::steady_clock::now() + quiet_gap);
+                m_write_cv.wait_until(lock, until, [&]() {
+                    return m_write_queue.size() != seen || !m_writer_running;
+                });
+                if (m_write_queue.size() == seen || std::chrono::steady_clock::now() >= deadline) break;
+                seen = m_write_queue.size();
+            }
+        }
+        
+        // Non-transactional work (checkpoints) always runs on its own
+        while (!m_write_queue.empty() && batch.size() < max_batch) {
+            bool transactional = m_write_queue.front().transactional;
+            if (!transactional && !batch.empty()) break;
+            
+            batch.push_back(std::move(m_write_queue.front()));
+            m_write_queue.pop_front();
+            if (!transactional) break;
+        }
+        
+        lock.unlock();
+        commit_batch(batch);
+        last_batch_size = batch.size();
+        batch.clear();
+        lock.lock();
+    }
+}
 
-Event Database::get_event_by_id(int id) {
-    const std::string sql = "SELECT * FROM events WHERE id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
-        return Event{};
+void Database::commit_batch(std::vector<PendingWrite>& batch) {
+    if (batch.size() == 1 && !batch.front().transactional) {
+        bool applied = batch.front().apply(m_writer);
+        if (batch.front().done) batch.front().done(applied);
+        return;
     }
     
-    sqlite3_bind_int(stmt, 1, id);
+    // Each write gets a savepoint so a failing one is undone without
+    // taking the rest of the batch with it
+    std::vector<char> applied(batch.size(), 0);
+    bool committed = execute_statement(m_writer, StmtBegin);
+    if (committed) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            size_t recorded = m_pending_events.size();
+            execute_statement(m_writer, StmtSavepoint);
+            applied[i] = batch[i].apply(m_writer);
+            if (!applied[i]) {
+                execute_statement(m_writer, StmtRollbackToSavepoint);
+                m_pending_events.resize(recorded);
+            }
+            execute_statement(m_writer, StmtReleaseSavepoint);
+        }
+        
+        committed = execute_statement(m_writer, StmtCommit);
+        if (!committed) {
+            std::cerr << "Group commit of " << batch.size() << " writes failed" << std::endl;
+            execute_statement(m_writer, StmtRollback);
+        }
+    }
     
-    Event event;
-    if ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        event = event_from_row(stmt);
+    if (committed) {
+        m_commit_batches.fetch_add(1, std::memory_order_relaxed);
+        m_committed_writes.fetch_add(batch.size(), std::memory_order_relaxed);
+        // Before the completions, so a caller that saw its write acknowledged
+        // also reads it back
+        if (m_options.cache_events) {
+            m_events.publish(m_pending_events);
+        }
+        std::lock_guard<std::mutex> lock(m_listener_mutex);
+        if (m_change_listener && !m_pending_events.empty()) {
+            m_change_listener(m_pending_events);
+        }
     }
+    m_pending_events.clear();
     
-    sqlite3_finalize(stmt);
-    return event;
+    // Acknowledge only once the whole batch is durable
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (batch[i].done) {
+            batch[i].done(committed && applied[i]);
+        }
+    }
 }
 
-std::vector<Event> Database::get_events_needing_reminder() {
-    std::vector<Event> events;
-    const std::string sql = "SELECT * FROM events WHERE reminder_sent = 0 ORDER BY reminder_time ASC;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
-        return events;
+void Database::submit_write(PendingWrite write) {
+    {
+        std::unique_lock<std::mutex> lock(m_write_mutex);
+        
+        // Before start-up / after shutdown the calling thread owns the connection
+        if (!m_writer_running) {
+            lock.unlock();
+            std::vector<PendingWrite> batch;
+            batch.push_back(std::move(write));
+            commit_batch(batch);
+            return;
+        }
+        
+        m_write_queue.push_back(std::move(write));
     }
-    
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        events.push_back(event_from_row(stmt));
+    m_write_cv.notify_one();
+}
+
+bool Database::with_writer(const std::function<bool(Connection&)>& fn, bool transactional) {
+    {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        
+        // Already inside a batch on the writer thread: join its transaction
+        if (m_writer_running && std::this_thread::get_id() == m_writer_thread_id) {
+            return fn(m_writer);
+        }
     }
     
-    sqlite3_finalize(stmt);
-    return events;
+    std::promise<bool> done;
+    auto committed = done.get_future();
+    
+    PendingWrite write;
+    write.apply = fn;
+    write.done = [&done](bool success) {
+        done.set_value(success);
+    };
+    write.transactional = transactional;
+    
+    submit_write(std::move(write));
+    return committed.get();
 }
 
-// Event Database::event_from_row(sqlite3_stmt* stmt) {
-//     Event event;
+void Database::with_reader(const std::function<void(Connection&)>& fn) {
+    if (m_readers.empty()) {
+        with_writer([&](Connection& conn) {
+            fn(conn);
+            return true;
+        });
+        return;
+    }
     
-//     event.id = sqlite3_column_int(stmt, 0);
-//     event.title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-//     event.description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    Connection* reader = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(m_reader_mutex);
+        m_reader_cv.wait(lock, [this]() {
+            return !m_idle_readers.empty();
+        });
+        reader = m_idle_readers.back();
+        m_idle_readers.pop_back();
+    }
     
-//     auto event_time_ms = sqlite3_column_int64(stmt, 3);
-//     auto reminder_time_ms = sqlite3_column_int64(stmt, 4);
+    fn(*reader);
     
-//     if (sqlite3_column_text(stmt, 5)) {
-//         event.creator = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-//     }
+    {
+        std::lock_guard<std::mutex> lock(m_reader_mutex);
+        m_idle_readers.push_back(reader);
+    }
+    m_reader_cv.notify_one();
+}
+
+int Database::schema_version() {
+    int version = 0;
+    with_writer([&](Connection& conn) {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(conn.db, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                version = sqlite3_column_int(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        return true;
+    }, false);
+    return version;
+}
+
+bool Database::migrate() {
+    int current = schema_version();
+    const int latest = kMigrations[sizeof(kMigrations) / sizeof(kMigrations[0]) - 1].version;
     
-//     event.reminder_sent = sqlite3_column_int(stmt, 6) == 1;
-//     auto created_at_ms = sqlite3_column_int64(stmt, 7);
+    if (current > latest) {
+        std::cerr << "Database schema version " << current << " is newer than this server ("
+                  << latest << ")" << std::endl;
+        return false;
+    }
     
-//     event.event_time = std::chrono::system_clock::time_point(
-//         std::chrono::milliseconds(event_time_ms));
-//     event.reminder_time = std::chrono::system_clock::time_point(
-//         std::chrono::milliseconds(reminder_time_ms));
-//     event.created_at = std::chrono::system_clock::time_point(
-//         std::chrono::milliseconds(created_at_ms));
+    for (const auto& migration : kMigrations) {
+        if (migration.version <= current) continue;
+        
+        // Schema change and version bump commit together, so a crash midway
+        // re-runs the whole step on the next start
+        if (!execute_sql(m_writer.db, "BEGIN IMMEDIATE;")) {
+            return false;
+        }
+        if (!execute_sql(m_writer.db, migration.sql) ||
+            !execute_sql(m_writer.db, "PRAGMA user_version = " + std::to_string(migration.version) + ";")) {
+            std::cerr << "Migration " << migration.version << " (" << migration.description
+                      << ") failed" << std::endl;
+            execute_sql(m_writer.db, "ROLLBACK;");
+            return false;
+        }
+        if (!execute_sql(m_writer.db, "COMMIT;")) {
+            execute_sql(m_writer.db, "ROLLBACK;");
+            return false;
+        }
+        
+        std::cout << "Applied migration " << migration.version << ": "
+                  << migration.description << std::endl;
+        current = migration.version;
+    }
     
-//     return event;
-// }
+    return true;
+}
 
-//chages to add my files
-// Add these methods to the end of Database.cpp file
+bool Database::verify_query_plans() {
+    bool all_indexed = true;
+    
+    with_writer([&](Connection& conn) {
+        for (const IndexedStatement& statement : kIndexedStatements) {
+            const char* name = kStatements[statement.id].name;
+            std::string sql = std::string("EXPLAIN QUERY PLAN ") + kStatements[statement.id].sql;
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(conn.db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+                std::cerr << "Cannot explain " << name << ": " << sqlite3_errmsg(conn.db) << std::endl;
+                all_indexed = false;
+                continue;
+            }
+            
+            // Columns: id, parent, notused, detail
+            bool used[2] = {false, false};
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+                std::string detail = text ? text : "";
+                
+                // Every table access must go through one of the expected indexes
+                bool reads_table = detail.rfind("SCAN ", 0) == 0 || detail.rfind("SEARCH ", 0) == 0;
+                bool expected = false;
+                for (size_t i = 0; i < 2 && statement.indexes[i]; ++i) {
+                    if (plan_uses_index(detail, statement.indexes[i])) {
+                        used[i] = expected = true;
+                    }
+                }
+                bool temp_sort = detail.find("TEMP B-TREE") != std::string::npos;
+                if ((reads_table && !expected) || temp_sort) {
+                    std::cerr << "Query plan regression in " << name << ": " << detail << std::endl;
+                    all_indexed = false;
+                }
+            }
+            sqlite3_finalize(stmt);
+            
+            for (size_t i = 0; i < 2 && statement.indexes[i]; ++i) {
+                if (!used[i]) {
+                    std::cerr << "Query plan regression in " << name << ": does not use "
+                              << statement.indexes[i] << std::endl;
+                    all_indexed = false;
+                }
+            }
+        }
+        return true;
+    }, false);
+    
+    return all_indexed;
+}
 
-std::vector<Event> Database::get_events_for_user(int user_id) {
-    std::vector<Event> events;
-    const std::string sql = "SELECT * FROM events WHERE user_id = ? ORDER BY event_time ASC;";
+bool Database::apply_options(sqlite3* db, bool is_writer) {
+    sqlite3_busy_timeout(db, m_options.busy_timeout_ms);
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    bool success =
+        execute_sql(db, "PRAGMA cache_size=-" + std::to_string(m_options.cache_size_kib) + ";") &&
+        execute_sql(db, "PRAGMA mmap_size=" + std::to_string(m_options.mmap_size_bytes) + ";") &&
+        execute_sql(db, "PRAGMA temp_store=" + m_options.temp_store + ";");
     
-    if (rc != SQLITE_OK) {
-        return events;
+    // Journal and sync settings belong to the connection that writes
+    if (!is_writer) {
+        return success;
+    }
+    
+    // journal_mode reports the mode actually in effect (":memory:" stays "memory")
+    std::string journal_mode;
+    sqlite3_stmt* stmt = nullptr;
+    std::string journal_sql = "PRAGMA journal_mode=" + m_options.journal_mode + ";";
+    if (sqlite3_prepare_v2(db, journal_sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0)) {
+            journal_mode = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
     }
+    m_wal_enabled = (journal_mode == "wal");
     
-    sqlite3_bind_int(stmt, 1, user_id);
+    success = success &&
+        execute_sql(db, "PRAGMA synchronous=" + m_options.synchronous + ";") &&
+        execute_sql(db, "PRAGMA wal_autocheckpoint=" + std::to_string(m_options.wal_autocheckpoint_pages) + ";");
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        events.push_back(event_from_row(stmt));
+    std::cout << "Database profile: " << DatabaseOptions::profile_name(m_options.profile)
+              << " (journal_mode=" << journal_mode << ", synchronous=" << m_options.synchronous
+              << ")" << std::endl;
+    return success;
+}
+
+bool Database::checkpoint(bool truncate) {
+    if (!m_wal_enabled) return false;
+    
+    bool complete = false;
+    // A checkpoint cannot run inside the batch transaction
+    with_writer([&](Connection& conn) {
+        if (!conn.db) return false;
+        
+        int wal_frames = 0;
+        int checkpointed_frames = 0;
+        int rc = sqlite3_wal_checkpoint_v2(conn.db, nullptr,
+                                           truncate ? SQLITE_CHECKPOINT_TRUNCATE : SQLITE_CHECKPOINT_PASSIVE,
+                                           &wal_frames, &checkpointed_frames);
+        if (rc != SQLITE_OK && rc != SQLITE_BUSY) {
+            std::cerr << "WAL checkpoint failed: " << sqlite3_errmsg(conn.db) << std::endl;
+            return false;
+        }
+        complete = rc == SQLITE_OK && wal_frames == checkpointed_frames;
+        return true;
+    }, false);
+    return complete;
+}
+
+void Database::checkpointLoop() {
+    std::unique_lock<std::mutex> lock(m_checkpoint_mutex);
+    while (m_checkpoint_running) {
+        m_checkpoint_cv.wait_for(lock, m_options.checkpoint_interval, [this]() {
+            return !m_checkpoint_running;
+        });
+        if (!m_checkpoint_running) break;
+        
+        lock.unlock();
+        checkpoint(false);
+        lock.lock();
     }
+}
+
+std::vector<StatementStats> Database::get_statement_stats() {
+    std::vector<StatementStats> result;
+    with_writer([&](Connection& conn) {
+        result = conn.statements.stats();
+        return true;
+    }, false);
+    
+    // Fold each reader's counters into the matching writer entry; waiting
+    // until every reader is idle keeps the counters stable while copying
+    std::unique_lock<std::mutex> lock(m_reader_mutex);
+    m_reader_cv.wait(lock, [this]() {
+        return m_idle_readers.size() == m_readers.size();
+    });
+    for (const auto& reader : m_readers) {
+        for (const auto& stat : reader->statements.stats()) {
+            for (auto& total : result) {
+                if (total.name == stat.name) {
+                    total.executions += stat.executions;
+                    total.total_ms += stat.total_ms;
+                    break;
+                }
+            }
+        }
+    }
+    lock.unlock();
+    m_reader_cv.notify_all();
     
-    sqlite3_finalize(stmt);
-    return events;
+    return result;
 }
 
-int Database::create_user(const User& user) {
-    const std::string sql = R"(
-        INSERT INTO users (username, email, password_hash, display_name, created_at, last_login, is_active)
-        VALUES (?, ?, ?, ?, ?, ?, ?);
-    )";
+void Database::log_statement_stats() {
+    for (const auto& stat : get_statement_stats()) {
+        if (stat.executions == 0) continue;
+        std::cout << "  " << stat.name << ": " << stat.executions << " executions, "
+                  << stat.total_ms << " ms total, "
+                  << (stat.total_ms * 1000.0 / stat.executions) << " us avg" << std::endl;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    uint64_t batches = m_commit_batches.load();
+    uint64_t writes = m_committed_writes.load();
+    if (batches > 0) {
+        std::cout << "  group commit: " << writes << " writes in " << batches << " transactions, "
+                  << (static_cast<double>(writes) / batches) << " per commit" << std::endl;
+    }
+}
+
+bool Database::execute_sql(sqlite3* db, const std::string& sql) {
+    char* error_msg = nullptr;
+    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &error_msg);
     
     if (rc != SQLITE_OK) {
-        std::cerr << "Failed to prepare user insert statement: " << sqlite3_errmsg(m_db) << std::endl;
-        return -1;
+        std::cerr << "SQL error: " << error_msg << std::endl;
+        sqlite3_free(error_msg);
+        return false;
     }
     
-    auto created_at_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        user.created_at.time_since_epoch()).count();
-    auto last_login_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        user.last_login.time_since_epoch()).count();
-    
-    sqlite3_bind_text(stmt, 1, user.username.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, user.email.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, user.password_hash.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, user.display_name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 5, created_at_ms);
-    sqlite3_bind_int64(stmt, 6, last_login_ms);
-    sqlite3_bind_int(stmt, 7, user.is_active ? 1 : 0);
+    return true;
+}
+
+bool Database::execute_statement(Connection& conn, StatementId id) {
+    auto stmt = conn.statements.acquire(id);
+    if (!stmt) return false;
     
-    rc = sqlite3_step(stmt);
-    int user_id = -1;
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(conn.db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int Database::create_event(const Event& event) {
+    int event_id = -1;
+    bool committed = with_writer([&](Connection& conn) {
+        return insert_event(conn, event, event_id);
+    });
+    return committed ? event_id : -1;
+}
+
+bool Database::update_event(const Event& event) {
+    return with_writer([&](Connection& conn) {
+        return write_event(conn, event);
+    });
+}
+
+bool Database::delete_event(int event_id) {
+    return with_writer([&](Connection& conn) {
+        return remove_event(conn, event_id);
+    });
+}
+
+void Database::create_event_async(Event event, std::function<void(EventPtr created)> done) {
+    auto created = std::make_shared<EventPtr>();
+    
+    PendingWrite write;
+    write.apply = [this, event = std::move(event), created](Connection& conn) {
+        int event_id = -1;
+        return insert_event(conn, event, event_id, created.get());
+    };
+    write.done = [created, done = std::move(done)](bool committed) {
+        if (done) done(committed ? *created : nullptr);
+    };
+    submit_write(std::move(write));
+}
+
+void Database::update_event_async(const Event& event, std::function<void(bool success)> done) {
+    PendingWrite write;
+    write.apply = [this, event](Connection& conn) {
+        return write_event(conn, event);
+    };
+    write.done = std::move(done);
+    submit_write(std::move(write));
+}
+
+void Database::delete_event_async(int event_id, std::function<void(bool success)> done) {
+    PendingWrite write;
+    write.apply = [this, event_id](Connection& conn) {
+        return remove_event(conn, event_id);
+    };
+    write.done = std::move(done);
+    submit_write(std::move(write));
+}
+
+WriteResult Database::update_owned_event(const Event& event, int user_id, EventPtr* current) {
+    WriteResult result = WriteResult::Failed;
+    EventPtr stored;
+    bool committed = with_writer([&](Connection& conn) {
+        result = write_owned_event(conn, event, user_id, stored);
+        return result != WriteResult::Failed;
+    });
+    if (current) *current = stored;
+    return committed ? result : WriteResult::Failed;
+}
+
+WriteResult Database::delete_owned_event(int event_id, int user_id, int expected_version) {
+    WriteResult result = WriteResult::Failed;
+    bool committed = with_writer([&](Connection& conn) {
+        result = remove_owned_event(conn, event_id, user_id, expected_version);
+        return result != WriteResult::Failed;
+    });
+    return committed ? result : WriteResult::Failed;
+}
+
+void Database::update_owned_event_async(Event event, int user_id,
+                                        std::function<void(WriteResult result, EventPtr current)> done) {
+    // Filled in by apply, read by done; one allocation for both
+    struct Outcome {
+        WriteResult result = WriteResult::Failed;
+        EventPtr current;
+    };
+    auto outcome = std::make_shared<Outcome>();
+    
+    PendingWrite write;
+    write.apply = [this, event = std::move(event), user_id, outcome](Connection& conn) {
+        outcome->result = write_owned_event(conn, event, user_id, outcome->current);
+        return outcome->result != WriteResult::Failed;
+    };
+    write.done = [outcome, done = std::move(done)](bool committed) {
+        if (done) done(committed ? outcome->result : WriteResult::Failed, outcome->current);
+    };
+    submit_write(std::move(write));
+}
+
+void Database::delete_owned_event_async(int event_id, int user_id, int expected_version,
+                                        std::function<void(WriteResult result)> done) {
+    auto result = std::make_shared<WriteResult>(WriteResult::Failed);
+    
+    PendingWrite write;
+    write.apply = [this, event_id, user_id, expected_version, result](Connection& conn) {
+        *result = remove_owned_event(conn, event_id, user_id, expected_version);
+        return *result != WriteResult::Failed;
+    };
+    write.done = [result, done = std::move(done)](bool committed) {
+        if (done) done(committed ? *result : WriteResult::Failed);
+    };
+    submit_write(std::move(write));
+}
+
+int Database::import_events(const std::vector<Event>& events) {
+    bool committed = with_writer([&](Connection& conn) {
+        return insert_events(conn, events);
+    });
+    return committed ? static_cast<int>(events.size()) : -1;
+}
+
+void Database::import_events_async(std::vector<Event> events,
+                                   std::function<void(bool committed, const std::vector<EventPtr>& imported)> done) {
+    auto chunk = std::make_shared<std::vector<Event>>(std::move(events));
+    auto stored = std::make_shared<std::vector<EventPtr>>();
+    
+    PendingWrite write;
+    write.apply = [this, chunk, stored](Connection& conn) {
+        stored->clear();
+        return insert_events(conn, *chunk, stored.get());
+    };
+    write.done = [stored, done](bool committed) {
+        if (!committed) stored->clear();
+        if (done) done(committed, *stored);
+    };
+    submit_write(std::move(write));
+}
+
+bool Database::apply_event_batch(std::vector<EventOperation>& operations, int user_id,
+                                 size_t& failed_at, WriteResult& failure) {
+    failed_at = operations.size();
+    failure = WriteResult::Failed;
+    return with_writer([&](Connection& conn) {
+        return apply_operations(conn, operations, user_id, failed_at, failure);
+    });
+}
+
+void Database::apply_event_batch_async(std::vector<EventOperation> operations, int user_id,
+                                       std::function<void(bool committed, const std::vector<EventOperation>& operations,
+                                                          size_t failed_at, WriteResult failure)> done) {
+    struct BatchState {
+        std::vector<EventOperation> operations;
+        size_t failed_at;
+        WriteResult failure = WriteResult::Failed;
+    };
+    auto state = std::make_shared<BatchState>();
+    state->operations = std::move(operations);
+    state->failed_at = state->operations.size();
+    
+    PendingWrite write;
+    write.apply = [this, state, user_id](Connection& conn) {
+        return apply_operations(conn, state->operations, user_id, state->failed_at, state->failure);
+    };
+    write.done = [state, done](bool committed) {
+        if (done) done(committed, state->operations, state->failed_at, state->failure);
+    };
+    submit_write(std::move(write));
+}
+
+size_t Database::export_events(const std::function<void(const Event&)>& sink) {
+    size_t rows = 0;
+    
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectAllEvents);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            sink(event_from_row(stmt));
+            ++rows;
+        }
+    });
+    
+    return rows;
+}
+
+bool Database::insert_events(Connection& conn, const std::vector<Event>& events, std::vector<EventPtr>* stored) {
+    int event_id = 0;
+    EventPtr row;
+    if (stored) stored->reserve(stored->size() + events.size());
+    for (const auto& event : events) {
+        if (!insert_event(conn, event, event_id, stored ? &row : nullptr)) {
+            return false;
+        }
+        if (stored) stored->push_back(std::move(row));
+    }
+    return true;
+}
+
+bool Database::apply_operations(Connection& conn, std::vector<EventOperation>& operations, int user_id,
+                                size_t& failed_at, WriteResult& failure) {
+    for (size_t i = 0; i < operations.size(); ++i) {
+        EventOperation& operation = operations[i];
+        WriteResult result = WriteResult::Failed;
+        EventPtr current;
+        
+        switch (operation.type) {
+        case EventOperation::Create:
+            operation.event.user_id = user_id;
+            if (insert_event(conn, operation.event, operation.event_id, &current)) {
+                operation.event = *current;
+                result = WriteResult::Applied;
+            }
+            break;
+        case EventOperation::Update:
+            result = write_owned_event(conn, operation.event, user_id, current);
+            // A no-op entry doesn't fail the batch; it carries the stored row
+            if (result == WriteResult::Applied || result == WriteResult::Unchanged) {
+                operation.event = *current;
+            }
+            break;
+        case EventOperation::Delete:
+            result = remove_owned_event(conn, operation.event_id, user_id, operation.event.version);
+            break;
+        }
+        
+        if (result != WriteResult::Applied && result != WriteResult::Unchanged) {
+            failed_at = i;
+            failure = result;
+            return false;
+        }
+    }
+    return true;
+}
+
+WriteResult Database::write_owned_event(Connection& conn, const Event& event, int user_id, EventPtr& current) {
+    {
+        auto stmt = conn.statements.acquire(StmtUpdateOwnedEvent);
+        
+        if (!stmt) {
+            return WriteResult::Failed;
+        }
+        
+        RowCodec::bind(stmt, event);
+        sqlite3_bind_int(stmt, 12, user_id);
+        
+        int rc = sqlite3_step(stmt);
+        if (rc == SQLITE_ROW) {
+            current = std::make_shared<const Event>(event_from_row(stmt));
+            // Step to SQLITE_DONE so the statement completes before the reset
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                return WriteResult::Failed;
+            }
+            record_event(current);
+            return WriteResult::Applied;
+        }
+        if (rc != SQLITE_DONE) {
+            std::cerr << "Failed to update event: " << sqlite3_errmsg(conn.db) << std::endl;
+            return WriteResult::Failed;
+        }
+    }
     
-    if (rc == SQLITE_DONE) {
-        user_id = static_cast<int>(sqlite3_last_insert_rowid(m_db));
-    } else {
-        std::cerr << "Failed to insert user: " << sqlite3_errmsg(m_db) << std::endl;
+    return explain_missed_write(conn, event.id, user_id, event.version, current);
+}
+
+WriteResult Database::remove_owned_event(Connection& conn, int event_id, int user_id, int expected_version) {
+    {
+        auto stmt = conn.statements.acquire(StmtDeleteOwnedEvent);
+        
+        if (!stmt) {
+            return WriteResult::Failed;
+        }
+        
+        sqlite3_bind_int(stmt, 1, event_id);
+        sqlite3_bind_int(stmt, 2, user_id);
+        sqlite3_bind_int(stmt, 3, expected_version);
+        
+        int rc = sqlite3_step(stmt);
+        if (rc == SQLITE_ROW) {
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                return WriteResult::Failed;
+            }
+            record_event_erased(event_id);
+            return WriteResult::Applied;
+        }
+        if (rc != SQLITE_DONE) {
+            std::cerr << "Failed to delete event: " << sqlite3_errmsg(conn.db) << std::endl;
+            return WriteResult::Failed;
+        }
     }
     
-    sqlite3_finalize(stmt);
-    return user_id;
+    EventPtr current;
+    return explain_missed_write(conn, event_id, user_id, expected_version, current);
 }
 
-bool Database::update_user(const User& user) {
-    const std::string sql = R"(
-        UPDATE users 
-        SET username = ?, email = ?, password_hash = ?, display_name = ?, 
-            last_login = ?, is_active = ?
-        WHERE id = ?;
-    )";
+WriteResult Database::explain_missed_write(Connection& conn, int event_id, int user_id,
+                                           int expected_version, EventPtr& current) {
+    // Only reached when the conditional statement matched nothing
+    auto stmt = conn.statements.acquire(StmtSelectEventById);
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    if (!stmt) {
+        return WriteResult::Failed;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "Failed to prepare user update statement: " << sqlite3_errmsg(m_db) << std::endl;
+    sqlite3_bind_int(stmt, 1, event_id);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        return WriteResult::NotFound;
+    }
+    
+    current = std::make_shared<const Event>(event_from_row(stmt));
+    if (current->user_id != user_id) {
+        return WriteResult::PermissionDenied;
+    }
+    if (expected_version != 0 && current->version != expected_version) {
+        return WriteResult::Conflict;
+    }
+    return WriteResult::Unchanged;
+}
+
+bool Database::insert_event(Connection& conn, const Event& event, int& event_id, EventPtr* stored) {
+    auto stmt = conn.statements.acquire(StmtInsertEvent);
+    
+    if (!stmt) {
         return false;
     }
     
-    auto last_login_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        user.last_login.time_since_epoch()).count();
+    // No reminder has gone out for a new event, whatever last_reminded the
+    // client sent (one in the future would suppress them)
+    auto row = std::make_shared<Event>(event);
+    row->recurrence.last_reminded = Recurrence::TimePoint();
+    RowCodec::bind(stmt, *row);
     
-    sqlite3_bind_text(stmt, 1, user.username.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, user.email.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, user.password_hash.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, user.display_name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 5, last_login_ms);
-    sqlite3_bind_int(stmt, 6, user.is_active ? 1 : 0);
-    sqlite3_bind_int(stmt, 7, user.id);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        std::cerr << "Failed to insert event: " << sqlite3_errmsg(conn.db) << std::endl;
+        return false;
+    }
     
-    rc = sqlite3_step(stmt);
-    bool success = (rc == SQLITE_DONE);
+    event_id = static_cast<int>(sqlite3_last_insert_rowid(conn.db));
     
-    sqlite3_finalize(stmt);
-    return success;
+    row->id = event_id;
+    row->version = 1;   // column default
+    if (stored) *stored = row;
+    record_event(std::move(row));
+    return true;
 }
 
-bool Database::update_user_last_login(int user_id) {
-    const std::string sql = "UPDATE users SET last_login = ? WHERE id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+bool Database::write_event(Connection& conn, const Event& event) {
+    auto stmt = conn.statements.acquire(StmtUpdateEvent);
     
-    if (rc != SQLITE_OK) {
+    if (!stmt) {
         return false;
     }
     
-    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
+    RowCodec::bind(stmt, event);
     
-    sqlite3_bind_int64(stmt, 1, now_ms);
-    sqlite3_bind_int(stmt, 2, user_id);
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        record_event(std::make_shared<const Event>(event_from_row(stmt)));
+        rc = sqlite3_step(stmt);
+    }
+    return rc == SQLITE_DONE;
+}
+
+bool Database::remove_event(Connection& conn, int event_id) {
+    auto stmt = conn.statements.acquire(StmtDeleteEvent);
     
-    rc = sqlite3_step(stmt);
-    bool success = (rc == SQLITE_DONE);
+    if (!stmt) {
+        return false;
+    }
     
-    sqlite3_finalize(stmt);
-    return success;
+    sqlite3_bind_int(stmt, 1, event_id);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        return false;
+    }
+    record_event_erased(event_id);
+    return true;
 }
 
-User Database::get_user_by_id(int id) {
-    const std::string sql = "SELECT * FROM users WHERE id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+std::vector<Event> Database::get_all_events() {
+    std::vector<Event> events;
     
-    if (rc != SQLITE_OK) {
-        return User{};
+    if (m_options.cache_events) {
+        auto stored = m_events.all();
+        events.reserve(stored.size());
+        for (const auto& event : stored) {
+            events.push_back(*event);
+        }
+        return events;
     }
     
-    sqlite3_bind_int(stmt, 1, id);
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectAllEvents);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            events.push_back(event_from_row(stmt));
+        }
+    });
     
-    User user;
-    if ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        user = user_from_row(stmt);
+    return events;
+}
+
+Event Database::get_event_by_id(int id) {
+    Event event;
+    
+    if (m_options.cache_events) {
+        EventPtr stored = m_events.find(id);
+        return stored ? *stored : event;
     }
     
-    sqlite3_finalize(stmt);
-    return user;
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectEventById);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        sqlite3_bind_int(stmt, 1, id);
+        
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            event = event_from_row(stmt);
+        }
+    });
+    
+    return event;
 }
 
-User Database::get_user_by_username(const std::string& username) {
-    const std::string sql = "SELECT * FROM users WHERE username = ?;";
+std::vector<Event> Database::get_events_needing_reminder() {
+    std::vector<Event> events;
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    if (m_options.cache_events) {
+        auto stored = m_events.pending_reminders();
+        events.reserve(stored.size());
+        for (const auto& event : stored) {
+            events.push_back(*event);
+        }
+        return events;
+    }
     
-    if (rc != SQLITE_OK) {
-        return User{};
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectEventsNeedingReminder);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            events.push_back(event_from_row(stmt));
+        }
+    });
+    
+    return events;
+}
+
+std::vector<Event> Database::get_due_reminders(std::chrono::system_clock::time_point now, size_t limit,
+                                              std::vector<int>& stale) {
+    std::vector<Event> events;
+    stale.clear();
+    
+    if (m_options.cache_events) {
+        auto due = m_events.due_reminders(now, limit, stale);
+        events.reserve(due.size());
+        for (const auto& event : due) {
+            events.push_back(*event);
+        }
+        return events;
     }
     
-    sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectDueReminders);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        sqlite3_bind_int64(stmt, 1, std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()).count());
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(limit));
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            Event event = event_from_row(stmt);
+            if (event.event_time > now) {
+                events.push_back(std::move(event));
+            } else {
+                stale.push_back(event.id);
+            }
+        }
+    });
     
-    User user;
-    if ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        user = user_from_row(stmt);
+    return events;
+}
+
+std::vector<EventPtr> Database::claim_occurrence_reminders(
+    const std::vector<std::pair<int, std::chrono::system_clock::time_point>>& occurrences) {
+    std::vector<EventPtr> claimed;
+    if (occurrences.empty()) {
+        return claimed;
     }
     
-    sqlite3_finalize(stmt);
-    return user;
+    bool committed = with_writer([&](Connection& conn) {
+        claimed.clear();
+        for (const auto& occurrence : occurrences) {
+            auto stmt = conn.statements.acquire(StmtClaimOccurrenceReminder);
+            
+            if (!stmt) {
+                return false;
+            }
+            
+            sqlite3_bind_int(stmt, 1, occurrence.first);
+            sqlite3_bind_int64(stmt, 2, std::chrono::duration_cast<std::chrono::milliseconds>(
+                occurrence.second.time_since_epoch()).count());
+            
+            int rc = sqlite3_step(stmt);
+            if (rc == SQLITE_ROW) {
+                claimed.push_back(std::make_shared<const Event>(event_from_row(stmt)));
+                record_event(claimed.back());
+                rc = sqlite3_step(stmt);
+            }
+            if (rc != SQLITE_DONE) {
+                return false;
+            }
+        }
+        return true;
+    });
+    
+    if (!committed) {
+        claimed.clear();
+    }
+    return claimed;
 }
 
-User Database::get_user_by_email(const std::string& email) {
-    const std::string sql = "SELECT * FROM users WHERE email = ?;";
+std::vector<EventPtr> Database::mark_reminders_sent(const std::vector<int>& event_ids) {
+    std::vector<EventPtr> marked;
+    if (event_ids.empty()) {
+        return marked;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    std::string ids = "[";
+    for (size_t i = 0; i < event_ids.size(); ++i) {
+        if (i > 0) ids += ',';
+        ids += std::to_string(event_ids[i]);
+    }
+    ids += ']';
+    
+    bool committed = with_writer([&](Connection& conn) {
+        marked.clear();
+        auto stmt = conn.statements.acquire(StmtMarkRemindersSent);
+        
+        if (!stmt) {
+            return false;
+        }
+        
+        sqlite3_bind_text(stmt, 1, ids.c_str(), static_cast<int>(ids.size()), SQLITE_STATIC);
+        
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            marked.push_back(std::make_shared<const Event>(event_from_row(stmt)));
+        }
+        if (rc != SQLITE_DONE) {
+            return false;
+        }
+        for (const auto& event : marked) {
+            record_event(event);
+        }
+        return true;
+    });
+    
+    if (!committed) {
+        marked.clear();
+    }
+    return marked;
+}
+
+std::vector<Event> Database::get_events_for_user(int user_id) {
+    std::vector<Event> events;
     
-    if (rc != SQLITE_OK) {
-        return User{};
+    if (m_options.cache_events) {
+        auto stored = m_events.for_user(user_id);
+        events.reserve(stored.size());
+        for (const auto& event : stored) {
+            events.push_back(*event);
+        }
+        return events;
     }
     
-    sqlite3_bind_text(stmt, 1, email.c_str(), -1, SQLITE_STATIC);
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectEventsForUser);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        sqlite3_bind_int(stmt, 1, user_id);
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            events.push_back(event_from_row(stmt));
+        }
+    });
     
-    User user;
-    if ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        user = user_from_row(stmt);
+    return events;
+}
+
+std::vector<EventPtr> Database::list_events() {
+    if (m_options.cache_events) {
+        return m_events.all();
     }
     
-    sqlite3_finalize(stmt);
-    return user;
+    std::vector<EventPtr> events;
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectAllEvents);
+        
+        if (stmt) {
+            read_event_blocks(stmt, events);
+        }
+    });
+    return events;
 }
 
-bool Database::delete_user(int user_id) {
-    const std::string sql = "DELETE FROM users WHERE id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+std::vector<EventPtr> Database::list_events_between(std::chrono::system_clock::time_point from,
+                                                    std::chrono::system_clock::time_point to) {
+    std::vector<EventPtr> candidates;
+    if (m_options.cache_events) {
+        candidates = m_events.between(from, to);
+        auto recurring = m_events.recurring_before(to);
+        candidates.insert(candidates.end(), recurring.begin(), recurring.end());
+    } else {
+        with_reader([&](Connection& conn) {
+            auto stmt = conn.statements.acquire(StmtSelectEventsBetween);
+            
+            if (stmt) {
+                sqlite3_bind_int64(stmt, 1, std::chrono::duration_cast<std::chrono::milliseconds>(
+                    from.time_since_epoch()).count());
+                sqlite3_bind_int64(stmt, 2, std::chrono::duration_cast<std::chrono::milliseconds>(
+                    to.time_since_epoch()).count());
+                read_event_blocks(stmt, candidates);
+            }
+        });
+    }
     
-    if (rc != SQLITE_OK) {
-        return false;
+    std::vector<EventPtr> events;
+    events.reserve(candidates.size());
+    for (auto& event : candidates) {
+        if (!event->recurrence.is_recurring() ||
+            !event->recurrence.occurrences_between(event->event_time, from, to, 1).empty()) {
+            events.push_back(std::move(event));
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const EventPtr& a, const EventPtr& b) {
+        return std::make_pair(a->event_time, a->id) < std::make_pair(b->event_time, b->id);
+    });
+    return events;
+}
+
+EventPtr Database::find_event(int id) {
+    if (m_options.cache_events) {
+        return m_events.find(id);
     }
     
-    sqlite3_bind_int(stmt, 1, user_id);
-    rc = sqlite3_step(stmt);
-    bool success = (rc == SQLITE_DONE);
+    Event event = get_event_by_id(id);
+    return event.id == 0 ? nullptr : std::make_shared<const Event>(std::move(event));
+}
+
+int Database::create_user(const User& user) {
+    int user_id = -1;
     
-    sqlite3_finalize(stmt);
-    return success;
+    bool committed = with_writer([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtInsertUser);
+        
+        if (!stmt) {
+            return false;
+        }
+        
+        RowCodec::bind(stmt, user);
+        
+        int rc = sqlite3_step(stmt);
+        
+        if (rc == SQLITE_DONE) {
+            user_id = static_cast<int>(sqlite3_last_insert_rowid(conn.db));
+        } else if ((rc & 0xff) == SQLITE_CONSTRAINT) {
+            // UNIQUE(username) / UNIQUE(email) rejected a duplicate registration
+            std::cerr << "User already exists: " << sqlite3_errmsg(conn.db) << std::endl;
+        } else {
+            std::cerr << "Failed to insert user: " << sqlite3_errmsg(conn.db) << std::endl;
+        }
+        return rc == SQLITE_DONE;
+    });
+    
+    return committed ? user_id : -1;
 }
 
-User Database::user_from_row(sqlite3_stmt* stmt) {
+bool Database::update_user(const User& user) {
+    return with_writer([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtUpdateUser);
+        
+        if (!stmt) {
+            return false;
+        }
+        
+        RowCodec::bind(stmt, user);
+        
+        return sqlite3_step(stmt) == SQLITE_DONE;
+    });
+}
+
+bool Database::update_user_last_login(int user_id) {
+    return with_writer([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtUpdateUserLastLogin);
+        
+        if (!stmt) {
+            return false;
+        }
+        
+        auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        
+        sqlite3_bind_int64(stmt, 1, now_ms);
+        sqlite3_bind_int(stmt, 2, user_id);
+        
+        return sqlite3_step(stmt) == SQLITE_DONE;
+    });
+}
+
+bool Database::update_users_last_login(
+    const std::unordered_map<int, std::chrono::system_clock::time_point>& last_logins) {
+    if (last_logins.empty()) return true;
+    
+    // Runs as one write task, so the whole map lands in a single
+    // transaction (and one fsync) and rolls back together on failure
+    return with_writer([&](Connection& conn) {
+        for (const auto& entry : last_logins) {
+            auto stmt = conn.statements.acquire(StmtUpdateUserLastLogin);
+            if (!stmt) {
+                return false;
+            }
+            
+            auto last_login_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                entry.second.time_since_epoch()).count();
+            
+            sqlite3_bind_int64(stmt, 1, last_login_ms);
+            sqlite3_bind_int(stmt, 2, entry.first);
+            
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                std::cerr << "Failed to update last_login: " << sqlite3_errmsg(conn.db) << std::endl;
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+User Database::get_user_by_id(int id) {
     User user;
     
-    user.id = sqlite3_column_int(stmt, 0);
-    user.username = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-    user.email = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-    user.password_hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-    user.display_name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-    
-    auto created_at_ms = sqlite3_column_int64(stmt, 5);
-    auto last_login_ms = sqlite3_column_int64(stmt, 6);
-    
-    user.is_active = sqlite3_column_int(stmt, 7) == 1;
-    
-    user.created_at = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(created_at_ms));
-    user.last_login = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(last_login_ms));
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectUserById);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        sqlite3_bind_int(stmt, 1, id);
+        
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            user = user_from_row(stmt);
+        }
+    });
     
     return user;
 }
 
-// Also update the event_from_row method to handle user_id
-Event Database::event_from_row(sqlite3_stmt* stmt) {
-    Event event;
-    
-    event.id = sqlite3_column_int(stmt, 0);
-    event.user_id = sqlite3_column_int(stmt, 1);  // NEW: user_id column
-    event.title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-    event.description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-    
-    auto event_time_ms = sqlite3_column_int64(stmt, 4);
-    auto reminder_time_ms = sqlite3_column_int64(stmt, 5);
+User Database::get_user_by_username(const std::string& username) {
+    User user;
     
-    if (sqlite3_column_text(stmt, 6)) {
-        event.creator = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-    }
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectUserByUsername);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
+        
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            user = user_from_row(stmt);
+        }
+    });
     
-    event.reminder_sent = sqlite3_column_int(stmt, 7) == 1;
-    auto created_at_ms = sqlite3_column_int64(stmt, 8);
+    return user;
+}
+
+User Database::get_user_by_email(const std::string& email) {
+    User user;
     
-    event.event_time = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(event_time_ms));
-    event.reminder_time = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(reminder_time_ms));
-    event.created_at = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(created_at_ms));
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectUserByEmail);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        sqlite3_bind_text(stmt, 1, email.c_str(), -1, SQLITE_STATIC);
+        
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            user = user_from_row(stmt);
+        }
+    });
     
+    return user;
+}
+
+std::vector<User> Database::get_all_users() {
+    std::vector<User> users;
+    
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectAllUsers);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            users.push_back(user_from_row(stmt));
+        }
+    });
+    
+    return users;
+}
+
+bool Database::delete_user(int user_id) {
+    return with_writer([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtDeleteUser);
+        
+        if (!stmt) {
+            return false;
+        }
+        
+        sqlite3_bind_int(stmt, 1, user_id);
+        return sqlite3_step(stmt) == SQLITE_DONE;
+    });
+}
+
+bool Database::add_revoked_token(const std::string& signature,
+                                 std::chrono::system_clock::time_point expires_at) {
+    return with_writer([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtInsertRevokedToken);
+        
+        if (!stmt) {
+            return false;
+        }
+        
+        auto expires_at_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            expires_at.time_since_epoch()).count();
+        
+        sqlite3_bind_text(stmt, 1, signature.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 2, expires_at_ms);
+        
+        return sqlite3_step(stmt) == SQLITE_DONE;
+    });
+}
+
+std::unordered_map<std::string, std::chrono::system_clock::time_point> Database::get_revoked_tokens() {
+    std::unordered_map<std::string, std::chrono::system_clock::time_point> revoked;
+    
+    with_reader([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtSelectRevokedTokens);
+        
+        if (!stmt) {
+            return;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            std::string signature = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            revoked[signature] = std::chrono::system_clock::time_point(
+                std::chrono::milliseconds(sqlite3_column_int64(stmt, 1)));
+        }
+    });
+    
+    return revoked;
+}
+
+bool Database::delete_expired_revoked_tokens() {
+    return with_writer([&](Connection& conn) {
+        auto stmt = conn.statements.acquire(StmtDeleteExpiredRevokedTokens);
+        
+        if (!stmt) {
+            return false;
+        }
+        
+        auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        sqlite3_bind_int64(stmt, 1, now_ms);
+        
+        return sqlite3_step(stmt) == SQLITE_DONE;
+    });
+}
+
+User Database::user_from_row(sqlite3_stmt* stmt) {
+    User user;
+    RowCodec::read(stmt, user);
+    return user;
+}
+
+Event Database::event_from_row(sqlite3_stmt* stmt) {
+    Event event{Event::Unset{}};
+    read_event_row(stmt, event);
     return event;
+}
+
+void Database::read_event_row(sqlite3_stmt* stmt, Event& event) {
+    if (!RowCodec::read(stmt, event)) {
+        // Only the recurrence column can fail; the event is then a single one
+        std::cerr << "Ignoring malformed recurrence of event " << event.id << std::endl;
+    }
+}
+
+// Materializes the rest of a query's rows into blocks of Events: each block
+// is one allocation holding up to a few thousand Events, and every EventPtr
+// aliases its element instead of owning a control block. Titles and
+// descriptions longer than the small-string buffer still allocate per row,
+// so a listing costs about two allocations per row rather than three.
+// Blocks start small and double, so short results don't reserve a full
+// block. Only listings with cache_events off come through here; the store
+// keeps individually owned events, since one long-lived survivor would pin
+// its whole block.
+void Database::read_event_blocks(sqlite3_stmt* stmt, std::vector<EventPtr>& events) {
+    const size_t kFirstBlock = 64;
+    const size_t kMaxBlock = 4096;
+    
+    bool more = true;
+    for (size_t block_rows = kFirstBlock; more; block_rows = std::min(block_rows * 2, kMaxBlock)) {
+        auto block = std::make_shared<std::vector<Event>>();
+        block->reserve(block_rows);
+        while (block->size() < block_rows) {
+            if (sqlite3_step(stmt) != SQLITE_ROW) {
+                more = false;
+                break;
+            }
+            block->emplace_back(Event::Unset{});
+            read_event_row(stmt, block->back());
+        }
+        // Aliasing constructor: shares the block's ownership, points at one Event
+        for (const Event& event : *block) {
+            events.emplace_back(block, &event);
+        }
+    }
 }
\ No newline at end of file
@@ -4,40 +4,284 @@
 #include <sqlite3.h>
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include "DatabaseOptions.h"
+#include "StatementCache.h"
 #include "Event.h"
+#include "EventBatch.h"
+#include "EventStore.h"
 #include "User.h"
 
+// Outcome of an owner- and version-checked event write
+enum class WriteResult {
+    Applied,
+    Unchanged,          // update would not change anything; nothing written
+    NotFound,
+    PermissionDenied,   // row belongs to another user
+    Conflict,           // row is no longer at the expected version
+    Failed              // SQLite error, or the transaction did not commit
+};
+
 class Database {
 public:
-    Database(const std::string& db_path);
+    Database(const std::string& db_path, const DatabaseOptions& options = DatabaseOptions());
     ~Database();
     
     bool initialize();
     
+    // Schema version (PRAGMA user_version) after migrations have run
+    int schema_version();
+    
+    // EXPLAIN QUERY PLAN over the hot statements; logs and returns false if
+    // any of them reads a table other than through its expected index, or
+    // sorts in a temporary b-tree
+    bool verify_query_plans();
+    
     // Event operations
     int create_event(const Event& event);
     bool update_event(const Event& event);
     bool delete_event(int event_id);
     std::vector<Event> get_all_events();
     std::vector<Event> get_events_needing_reminder();
+    // Events whose reminder is due at `now` (Event::needs_reminder),
+    // earliest reminder_time first. Unsent reminders of events that have
+    // already started are never due; their ids go to `stale` instead, to be
+    // passed to mark_reminders_sent so they stop being read. At most
+    // `limit` of both together.
+    std::vector<Event> get_due_reminders(std::chrono::system_clock::time_point now, size_t limit,
+                                         std::vector<int>& stale);
+    
+    // Flips reminder_sent for all of event_ids in one statement and one
+    // transaction. Returns the rows it changed; ids already marked (or gone)
+    // are left out, so each reminder is claimed exactly once.
+    std::vector<EventPtr> mark_reminders_sent(const std::vector<int>& event_ids);
+    
+    // Recurring events: records each (event id, occurrence start) as the
+    // rule's last_reminded, in one transaction. Returns the rows it changed;
+    // an occurrence at or before the stored last_reminded is left out, so
+    // each occurrence's reminder is claimed once.
+    std::vector<EventPtr> claim_occurrence_reminders(
+        const std::vector<std::pair<int, std::chrono::system_clock::time_point>>& occurrences);
     std::vector<Event> get_events_for_user(int user_id);
     Event get_event_by_id(int id);
     
+    // Shared immutable events, ordered by event_time / looked up by id,
+    // straight from the in-memory store (null if the id is unknown)
+    std::vector<EventPtr> list_events();
+    EventPtr find_event(int id);
+    
+    // Single events starting in [from, to) and recurring events with at
+    // least one occurrence there, ordered by event_time
+    std::vector<EventPtr> list_events_between(std::chrono::system_clock::time_point from,
+                                              std::chrono::system_clock::time_point to);
+    
+    // Queue the write and return immediately. `done` runs on the writer
+    // thread once the group-commit transaction holding it has committed
+    // (the stored event / true) or failed (null / false).
+    void create_event_async(Event event, std::function<void(EventPtr created)> done);
+    void update_event_async(const Event& event, std::function<void(bool success)> done);
+    void delete_event_async(int event_id, std::function<void(bool success)> done);
+    
+    // Client edits: one conditional UPDATE / DELETE ... RETURNING checks
+    // ownership and event.version (0 skips the version check) and writes.
+    // Only when it matches nothing is the row read back to tell the caller
+    // why. `current` is the row as stored afterwards (with its new version
+    // for Applied, the conflicting one for Conflict / Unchanged; else null).
+    WriteResult update_owned_event(const Event& event, int user_id, EventPtr* current = nullptr);
+    WriteResult delete_owned_event(int event_id, int user_id, int expected_version);
+    void update_owned_event_async(Event event, int user_id,
+                                  std::function<void(WriteResult result, EventPtr current)> done);
+    void delete_owned_event_async(int event_id, int user_id, int expected_version,
+                                  std::function<void(WriteResult result)> done);
+    
+    // Bulk load: all events go in as one write task (a single transaction),
+    // so the chunk is either fully imported or not at all. Returns the number
+    // of rows inserted, or -1. The async form hands `done` the rows as
+    // stored (ids and versions set), empty unless committed.
+    int import_events(const std::vector<Event>& events);
+    void import_events_async(std::vector<Event> events,
+                             std::function<void(bool committed, const std::vector<EventPtr>& imported)> done);
+    
+    // Mixed create/update/delete batch on behalf of user_id, applied as one
+    // write task so it commits all-or-nothing. Updates and deletes are
+    // owner- and version-checked like the single-event calls. Ids and new
+    // versions are written back into the operations. On failure `failed_at`
+    // is the index of the offending operation and `failure` says why
+    // (operations.size() / Failed if the commit itself failed).
+    bool apply_event_batch(std::vector<EventOperation>& operations, int user_id,
+                           size_t& failed_at, WriteResult& failure);
+    void apply_event_batch_async(std::vector<EventOperation> operations, int user_id,
+                                 std::function<void(bool committed, const std::vector<EventOperation>& operations,
+                                                    size_t failed_at, WriteResult failure)> done);
+    
+    // Called on the writer thread after every commit with the committed
+    // event rows in commit order (null EventPtr: id was deleted), before the
+    // writes' completions run. Keep it short; it delays the next batch.
+    using ChangeListener = std::function<void(const std::vector<std::pair<int, EventPtr>>& changes)>;
+    void set_change_listener(ChangeListener listener);
+    
+    // Streams every event (ordered by event_time) to sink as SQLite steps the
+    // rows, without materializing the table. Returns the number of rows.
+    size_t export_events(const std::function<void(const Event&)>& sink);
+    
     // User operations
     int create_user(const User& user);
     bool update_user(const User& user);
     bool update_user_last_login(int user_id);
+    bool update_users_last_login(const std::unordered_map<int, std::chrono::system_clock::time_point>& last_logins);
     User get_user_by_id(int id);
     User get_user_by_username(const std::string& username);
     User get_user_by_email(const std::string& email);
+    std::vector<User> get_all_users();
     bool delete_user(int user_id);
     
+    // Revoked signed session tokens (keyed by token signature)
+    bool add_revoked_token(const std::string& signature, std::chrono::system_clock::time_point expires_at);
+    std::unordered_map<std::string, std::chrono::system_clock::time_point> get_revoked_tokens();
+    bool delete_expired_revoked_tokens();
+    
+    // WAL maintenance (also run periodically by the checkpoint thread)
+    bool checkpoint(bool truncate = false);
+    
+    // Per-statement execution counters and timings
+    std::vector<StatementStats> get_statement_stats();
+    void log_statement_stats();
+    
+    // Slots in m_statements; SQL text lives in Database.cpp
+    enum StatementId {
+        StmtInsertEvent,
+        StmtUpdateEvent,
+        StmtDeleteEvent,
+        StmtUpdateOwnedEvent,
+        StmtDeleteOwnedEvent,
+        StmtSelectAllEvents,
+        StmtSelectEventById,
+        StmtSelectEventsNeedingReminder,
+        StmtSelectDueReminders,
+        StmtMarkRemindersSent,
+        StmtClaimOccurrenceReminder,
+        StmtSelectEventsBetween,
+        StmtSelectEventsForUser,
+        StmtInsertUser,
+        StmtUpdateUser,
+        StmtUpdateUserLastLogin,
+        StmtSelectUserById,
+        StmtSelectUserByUsername,
+        StmtSelectUserByEmail,
+        StmtSelectAllUsers,
+        StmtDeleteUser,
+        StmtInsertRevokedToken,
+        StmtSelectRevokedTokens,
+        StmtDeleteExpiredRevokedTokens,
+        StmtBegin,
+        StmtCommit,
+        StmtRollback,
+        StmtSavepoint,
+        StmtReleaseSavepoint,
+        StmtRollbackToSavepoint,
+        StmtCount
+    };
+    
 private:
-    sqlite3* m_db;
+    // One SQLite connection and the statements prepared on it. A connection
+    // is only ever used by one thread at a time.
+    struct Connection {
+        sqlite3* db = nullptr;
+        StatementCache statements;
+    };
+    
     std::string m_db_path;
+    DatabaseOptions m_options;
+    bool m_wal_enabled;
+    
+    // A queued mutation: apply() runs inside the batch transaction (returning
+    // false rolls back just that write), done() runs after COMMIT
+    struct PendingWrite {
+        std::function<bool(Connection&)> apply;
+        std::function<void(bool committed)> done;
+        bool transactional = true;
+    };
+    
+    // All writes go through m_writer on the writer thread, in queue order
+    Connection m_writer;
+    std::thread m_writer_thread;
+    std::thread::id m_writer_thread_id;
+    std::mutex m_write_mutex;
+    std::condition_variable m_write_cv;
+    std::deque<PendingWrite> m_write_queue;
+    bool m_writer_running;
+    
+    // In-memory events (DatabaseOptions::cache_events). Writes record the
+    // rows they produce in m_pending_events (writer thread only); a task's
+    // records are dropped if it rolls back, and the batch's are published
+    // to the store and the change listener once COMMIT succeeds, so readers
+    // never see uncommitted or out-of-order state.
+    EventStore m_events;
+    std::vector<std::pair<int, EventPtr>> m_pending_events;
+    std::mutex m_listener_mutex;
+    ChangeListener m_change_listener;
+    
+    // Group commit counters
+    std::atomic<uint64_t> m_commit_batches;
+    std::atomic<uint64_t> m_committed_writes;
+    
+    // Read-only WAL connections; reads run on whichever one is idle and
+    // never wait for the writer. Empty when WAL is unavailable (e.g. :memory:),
+    // in which case reads are queued on the writer as well.
+    std::vector<std::unique_ptr<Connection>> m_readers;
+    std::vector<Connection*> m_idle_readers;
+    std::mutex m_reader_mutex;
+    std::condition_variable m_reader_cv;
+    
+    // Background PASSIVE checkpoints so the WAL doesn't grow without bound
+    std::thread m_checkpoint_thread;
+    std::mutex m_checkpoint_mutex;
+    std::condition_variable m_checkpoint_cv;
+    std::atomic<bool> m_checkpoint_running;
+    
+    bool apply_options(sqlite3* db, bool is_writer);
+    bool migrate();
+    bool load_events();
+    void record_event(EventPtr event);
+    void record_event_erased(int event_id);
+    bool open_readers();
+    void close_readers();
+    void writerLoop();
+    void checkpointLoop();
+    
+    // Run fn on the writer connection, blocking until its batch has
+    // committed (returns false if fn or the commit failed), or on an idle
+    // reader connection
+    bool with_writer(const std::function<bool(Connection&)>& fn, bool transactional = true);
+    void with_reader(const std::function<void(Connection&)>& fn);
+    void submit_write(PendingWrite write);
+    void commit_batch(std::vector<PendingWrite>& batch);
+    
+    // `stored`, if given, receives the row as recorded (id and version set)
+    bool insert_event(Connection& conn, const Event& event, int& event_id, EventPtr* stored = nullptr);
+    bool write_event(Connection& conn, const Event& event);
+    bool remove_event(Connection& conn, int event_id);
+    // `stored`, if given, receives the rows as recorded
+    bool insert_events(Connection& conn, const std::vector<Event>& events, std::vector<EventPtr>* stored = nullptr);
+    WriteResult write_owned_event(Connection& conn, const Event& event, int user_id, EventPtr& current);
+    WriteResult remove_owned_event(Connection& conn, int event_id, int user_id, int expected_version);
+    WriteResult explain_missed_write(Connection& conn, int event_id, int user_id, int expected_version, EventPtr& current);
+    bool apply_operations(Connection& conn, std::vector<EventOperation>& operations, int user_id,
+                          size_t& failed_at, WriteResult& failure);
     
-    bool execute_sql(const std::string& sql);
+    bool execute_sql(sqlite3* db, const std::string& sql);
+    bool execute_statement(Connection& conn, StatementId id);
     Event event_from_row(sqlite3_stmt* stmt);
+    void read_event_row(sqlite3_stmt* stmt, Event& event);
+    void read_event_blocks(sqlite3_stmt* stmt, std::vector<EventPtr>& events);
     User user_from_row(sqlite3_stmt* stmt);
 };
 
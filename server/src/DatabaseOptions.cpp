@@ -0,0 +1,59 @@
+#include "DatabaseOptions.h"
+#include <algorithm>
+#include <cctype>
+
+DatabaseOptions DatabaseOptions::for_profile(DatabaseProfile profile) {
+    DatabaseOptions options;
+    options.profile = profile;
+
+    switch (profile) {
+    case DatabaseProfile::Durable:
+        options.synchronous = "FULL";
+        options.cache_size_kib = 16 * 1024;
+        options.mmap_size_bytes = 0;
+        options.temp_store = "DEFAULT";
+        options.wal_autocheckpoint_pages = 1000;
+        options.checkpoint_interval = std::chrono::seconds(30);
+        break;
+    case DatabaseProfile::Balanced:
+        // Defaults above
+        break;
+    case DatabaseProfile::Throughput:
+        options.synchronous = "OFF";
+        options.cache_size_kib = 256 * 1024;
+        options.mmap_size_bytes = 1024LL * 1024 * 1024;
+        options.busy_timeout_ms = 10000;
+        // Let the WAL grow between checkpoints instead of stalling writers
+        options.wal_autocheckpoint_pages = 0;
+        options.checkpoint_interval = std::chrono::seconds(10);
+        break;
+    }
+
+    return options;
+}
+
+bool DatabaseOptions::parse_profile(const std::string& name, DatabaseProfile& profile) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (lower == "durable") {
+        profile = DatabaseProfile::Durable;
+    } else if (lower == "balanced") {
+        profile = DatabaseProfile::Balanced;
+    } else if (lower == "throughput") {
+        profile = DatabaseProfile::Throughput;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* DatabaseOptions::profile_name(DatabaseProfile profile) {
+    switch (profile) {
+    case DatabaseProfile::Durable: return "durable";
+    case DatabaseProfile::Balanced: return "balanced";
+    case DatabaseProfile::Throughput: return "throughput";
+    }
+    return "unknown";
+}
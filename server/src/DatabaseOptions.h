@@ -0,0 +1,47 @@
+#ifndef DATABASE_OPTIONS_H
+#define DATABASE_OPTIONS_H
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// Named SQLite tuning presets, selected at startup (DB_PROFILE env var)
+enum class DatabaseProfile {
+    Durable,     // WAL + synchronous=FULL: every commit survives power loss
+    Balanced,    // WAL + synchronous=NORMAL: may lose the last commits on power loss, never corrupts
+    Throughput   // WAL + synchronous=OFF, large cache/mmap: for imports and benchmarks
+};
+
+struct DatabaseOptions {
+    DatabaseProfile profile = DatabaseProfile::Balanced;
+    std::string journal_mode = "WAL";
+    std::string synchronous = "NORMAL";
+    int cache_size_kib = 64 * 1024;
+    int64_t mmap_size_bytes = 256LL * 1024 * 1024;
+    std::string temp_store = "MEMORY";
+    int busy_timeout_ms = 5000;
+    
+    // Read-only connections opened next to the single writer (WAL only)
+    int reader_connections = 4;
+    
+    // Keep every event in memory (EventStore) and serve event reads from it;
+    // costs a few hundred bytes per event, so offline tools turn it off
+    bool cache_events = true;
+    
+    // Group commit: while writes are arriving back to back, the writer waits
+    // up to max_delay for more and commits up to max_batch of them in one
+    // transaction (one fsync). A lone write is committed without waiting.
+    int group_commit_max_batch = 128;
+    std::chrono::microseconds group_commit_max_delay{2000};
+
+    // WAL checkpointing: SQLite's automatic checkpoint threshold (pages, 0
+    // disables it) and how often the background thread runs a PASSIVE one
+    int wal_autocheckpoint_pages = 1000;
+    std::chrono::seconds checkpoint_interval{60};
+
+    static DatabaseOptions for_profile(DatabaseProfile profile);
+    static bool parse_profile(const std::string& name, DatabaseProfile& profile);
+    static const char* profile_name(DatabaseProfile profile);
+};
+
+#endif // DATABASE_OPTIONS_H
@@ -0,0 +1,175 @@
+#include "EventColumns.h"
+
+namespace {
+
+// Rows evaluated per mask block; the mask stays in L1
+const size_t kBlock = 1024;
+
+int64_t to_ms(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+void EventColumns::reserve(size_t rows) {
+    m_row_of.reserve(rows);
+    m_ids.reserve(rows);
+    m_user_ids.reserve(rows);
+    m_event_times.reserve(rows);
+    m_reminder_times.reserve(rows);
+    m_created_at.reserve(rows);
+    m_versions.reserve(rows);
+    m_reminder_sent.reserve(rows);
+}
+
+void EventColumns::clear() {
+    m_row_of.clear();
+    m_ids.clear();
+    m_user_ids.clear();
+    m_event_times.clear();
+    m_reminder_times.clear();
+    m_created_at.clear();
+    m_versions.clear();
+    m_reminder_sent.clear();
+}
+
+void EventColumns::upsert(const Event& event) {
+    auto it = m_row_of.find(event.id);
+    if (it != m_row_of.end()) {
+        set_row(it->second, event);
+        return;
+    }
+
+    uint32_t row = static_cast<uint32_t>(m_ids.size());
+    m_ids.push_back(event.id);
+    m_user_ids.push_back(0);
+    m_event_times.push_back(0);
+    m_reminder_times.push_back(0);
+    m_created_at.push_back(0);
+    m_versions.push_back(0);
+    m_reminder_sent.push_back(0);
+    m_row_of[event.id] = row;
+    set_row(row, event);
+}
+
+void EventColumns::erase(int id) {
+    auto it = m_row_of.find(id);
+    if (it == m_row_of.end()) return;
+
+    uint32_t row = it->second;
+    uint32_t last = static_cast<uint32_t>(m_ids.size() - 1);
+    m_row_of.erase(it);
+
+    if (row != last) {
+        m_ids[row] = m_ids[last];
+        m_user_ids[row] = m_user_ids[last];
+        m_event_times[row] = m_event_times[last];
+        m_reminder_times[row] = m_reminder_times[last];
+        m_created_at[row] = m_created_at[last];
+        m_versions[row] = m_versions[last];
+        m_reminder_sent[row] = m_reminder_sent[last];
+        m_row_of[m_ids[row]] = row;
+    }
+
+    m_ids.pop_back();
+    m_user_ids.pop_back();
+    m_event_times.pop_back();
+    m_reminder_times.pop_back();
+    m_created_at.pop_back();
+    m_versions.pop_back();
+    m_reminder_sent.pop_back();
+}
+
+size_t EventColumns::count_in_window(int64_t from_ms, int64_t to_ms) const {
+    const int64_t* times = m_event_times.data();
+    const size_t n = m_event_times.size();
+
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += static_cast<size_t>((times[i] >= from_ms) & (times[i] < to_ms));
+    }
+    return count;
+}
+
+void EventColumns::select_in_window(int64_t from_ms, int64_t to_ms, std::vector<uint32_t>& rows) const {
+    rows.clear();
+    const int64_t* times = m_event_times.data();
+    const size_t n = m_event_times.size();
+    uint8_t mask[kBlock];
+
+    for (size_t start = 0; start < n; start += kBlock) {
+        size_t count = std::min(kBlock, n - start);
+        const int64_t* t = times + start;
+        for (size_t i = 0; i < count; ++i) {
+            mask[i] = static_cast<uint8_t>((t[i] >= from_ms) & (t[i] < to_ms));
+        }
+        compact_rows(mask, count, static_cast<uint32_t>(start), rows);
+    }
+}
+
+void EventColumns::select_due_reminders(int64_t now_ms, std::vector<uint32_t>& rows) const {
+    rows.clear();
+    const int64_t* reminders = m_reminder_times.data();
+    const int64_t* events = m_event_times.data();
+    const uint8_t* sent = m_reminder_sent.data();
+    const size_t n = m_ids.size();
+    uint8_t mask[kBlock];
+
+    for (size_t start = 0; start < n; start += kBlock) {
+        size_t count = std::min(kBlock, n - start);
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = start + i;
+            mask[i] = static_cast<uint8_t>((sent[row] == 0) & (reminders[row] <= now_ms) & (events[row] > now_ms));
+        }
+        compact_rows(mask, count, static_cast<uint32_t>(start), rows);
+    }
+}
+
+void EventColumns::select_pending_reminders(int64_t before_ms, std::vector<uint32_t>& rows) const {
+    rows.clear();
+    const int64_t* reminders = m_reminder_times.data();
+    const uint8_t* sent = m_reminder_sent.data();
+    const size_t n = m_ids.size();
+    uint8_t mask[kBlock];
+
+    for (size_t start = 0; start < n; start += kBlock) {
+        size_t count = std::min(kBlock, n - start);
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = start + i;
+            mask[i] = static_cast<uint8_t>((sent[row] == 0) & (reminders[row] < before_ms));
+        }
+        compact_rows(mask, count, static_cast<uint32_t>(start), rows);
+    }
+}
+
+size_t EventColumns::memory_bytes() const {
+    return m_ids.capacity() * sizeof(int32_t) +
+           m_user_ids.capacity() * sizeof(int32_t) +
+           m_event_times.capacity() * sizeof(int64_t) +
+           m_reminder_times.capacity() * sizeof(int64_t) +
+           m_created_at.capacity() * sizeof(int64_t) +
+           m_versions.capacity() * sizeof(int32_t) +
+           m_reminder_sent.capacity() * sizeof(uint8_t);
+}
+
+void EventColumns::set_row(size_t row, const Event& event) {
+    m_user_ids[row] = event.user_id;
+    m_event_times[row] = to_ms(event.event_time);
+    m_reminder_times[row] = to_ms(event.reminder_time);
+    m_created_at[row] = to_ms(event.created_at);
+    m_versions[row] = event.version;
+    m_reminder_sent[row] = event.reminder_sent ? 1 : 0;
+}
+
+void EventColumns::compact_rows(const uint8_t* mask, size_t count, uint32_t first_row, std::vector<uint32_t>& rows) {
+    // Branch-free: always write, advance only on a match
+    size_t base = rows.size();
+    rows.resize(base + count);
+    uint32_t* out = rows.data() + base;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        out[kept] = first_row + static_cast<uint32_t>(i);
+        kept += mask[i];
+    }
+    rows.resize(base + kept);
+}
@@ -0,0 +1,60 @@
+#ifndef EVENT_COLUMNS_H
+#define EVENT_COLUMNS_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Event.h"
+
+// Structure-of-arrays copy of the events table's numeric fields for scans.
+// Each field is its own contiguous array indexed by row and times are epoch
+// milliseconds, so a time-window or reminder scan streams 8-byte integers
+// instead of whole Event objects. The text stays in the Events that own it.
+//
+// Rows are unordered: erase moves the last row into the hole. The scan
+// kernels are written as plain branch-free loops over the arrays so the
+// compiler can vectorize them (-O3); they return row numbers, which id()
+// maps back.
+class EventColumns {
+public:
+    // Insert or replace by id / erase by id (no-op if unknown)
+    void upsert(const Event& event);
+    void erase(int id);
+    void clear();
+    void reserve(size_t rows);
+
+    size_t size() const { return m_ids.size(); }
+    int id(uint32_t row) const { return m_ids[row]; }
+
+    // Rows with from_ms <= event_time < to_ms
+    size_t count_in_window(int64_t from_ms, int64_t to_ms) const;
+    void select_in_window(int64_t from_ms, int64_t to_ms, std::vector<uint32_t>& rows) const;
+
+    // Rows whose reminder is due at now_ms: not sent yet, reminder_time has
+    // passed and the event itself hasn't started
+    void select_due_reminders(int64_t now_ms, std::vector<uint32_t>& rows) const;
+
+    // Unsent reminders with reminder_time < before_ms (INT64_MAX: all)
+    void select_pending_reminders(int64_t before_ms, std::vector<uint32_t>& rows) const;
+
+    // Bytes held by the arrays (capacity, not size)
+    size_t memory_bytes() const;
+
+private:
+    void set_row(size_t row, const Event& event);
+
+    // Fills rows with every index whose mask byte is set
+    static void compact_rows(const uint8_t* mask, size_t count, uint32_t first_row, std::vector<uint32_t>& rows);
+
+    std::unordered_map<int, uint32_t> m_row_of;
+
+    std::vector<int32_t> m_ids;
+    std::vector<int32_t> m_user_ids;
+    std::vector<int64_t> m_event_times;
+    std::vector<int64_t> m_reminder_times;
+    std::vector<int64_t> m_created_at;
+    std::vector<int32_t> m_versions;
+    std::vector<uint8_t> m_reminder_sent;
+};
+
+#endif // EVENT_COLUMNS_H
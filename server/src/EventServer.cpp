@@ -1,8 +1,126 @@
 #include "EventServer.h"
 // #include "Protocol.h"  // Make sure this is included
 #include "../../shared/Protocol.h"
+#include "AllocationStats.h"
+#include "BulkIO.h"
+#include "EventBatch.h"
+#include "MessageArena.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <chrono>
+#include <cstdlib>
+
+namespace {
+
+// Per-thread scratch for streamed messages (JsonWriter). It grows to the
+// largest message once and is reused; each message is copied out at its
+// exact size when sent.
+std::string& message_buffer() {
+    thread_local std::string buffer;
+    buffer.clear();
+    return buffer;
+}
+
+int64_t epoch_ms(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+const char* write_result_code(WriteResult result) {
+    switch (result) {
+    case WriteResult::NotFound: return "NOT_FOUND";
+    case WriteResult::PermissionDenied: return "PERMISSION_DENIED";
+    case WriteResult::Conflict: return "VERSION_CONFLICT";
+    default: return "WRITE_FAILED";
+    }
+}
+
+std::string write_result_message(WriteResult result, bool is_delete) {
+    switch (result) {
+    case WriteResult::NotFound:
+        return "Event not found";
+    case WriteResult::PermissionDenied:
+        return is_delete ? "You can only delete your own events" : "You can only modify your own events";
+    case WriteResult::Conflict:
+        return "Event was changed by someone else; reload it and try again";
+    default:
+        return "Event could not be written";
+    }
+}
+
+// Whether a quoted member name, escapes and all, names a credential
+bool is_secret_key(const std::string& quoted) {
+    if (quoted.find('\\') == std::string::npos) {
+        return quoted == "\"password\"" || quoted == "\"auth_token\"";
+    }
+    auto key = nlohmann::json::parse(quoted, nullptr, false);
+    return key.is_string() && (key == "password" || key == "auth_token");
+}
+
+// A frame as RECORD_MESSAGES writes it: on one line, with the value of every
+// "password" and "auth_token" member replaced by "***". Strings are scanned
+// rather than parsed so truncated and invalid frames are masked as well.
+std::string recorded_frame(const std::string& message) {
+    std::string line;
+    line.reserve(message.size());
+    bool mask_value = false;   // after a secret key and its colon
+    size_t i = 0;
+    while (i < message.size()) {
+        char c = message[i];
+        if (c != '"') {
+            if (c != ':' && !std::isspace(static_cast<unsigned char>(c))) mask_value = false;
+            line += c;
+            ++i;
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < message.size() && message[end] != '"') end += message[end] == '\\' ? 2 : 1;
+        end = std::min(end + 1, message.size());
+        if (mask_value) {
+            line += "\"***\"";
+            mask_value = false;
+        } else {
+            std::string quoted = message.substr(i, end - i);
+            size_t next = message.find_first_not_of(" \t\r\n", end);
+            mask_value = next != std::string::npos && message[next] == ':' && is_secret_key(quoted);
+            line += quoted;
+        }
+        i = end;
+    }
+    // Newlines can only be whitespace between JSON tokens
+    std::replace(line.begin(), line.end(), '\n', ' ');
+    return line;
+}
+
+// {"code": ..., "error": ...} as a `type` message
+void send_error(const std::shared_ptr<WebSocketSession>& session, const std::string& type,
+                const char* code, const std::string& error) {
+    std::string& message = message_buffer();
+    Protocol::write_message(message, type, [&](JsonWriter& writer) {
+        writer.begin_object();
+        writer.key("code");
+        writer.value(code);
+        writer.key("error");
+        writer.value(error);
+        writer.end_object();
+    });
+    session->send(message);
+}
+
+// {"message": ...} as a `type` message
+void send_notice(const std::shared_ptr<WebSocketSession>& session, const std::string& type,
+                 const char* text) {
+    std::string& message = message_buffer();
+    Protocol::write_message(message, type, [&](JsonWriter& writer) {
+        writer.begin_object();
+        writer.key("message");
+        writer.value(text);
+        writer.end_object();
+    });
+    session->send(message);
+}
+
+} // namespace
 
 // WebSocketSession implementation
 WebSocketSession::WebSocketSession(tcp::socket&& socket)
@@ -30,7 +148,11 @@ void WebSocketSession::run() {
 }
 
 void WebSocketSession::send(const std::string& message) {
-    auto const ss = std::make_shared<std::string const>(std::move(message));
+    send(std::make_shared<std::string const>(message));
+}
+
+void WebSocketSession::send(std::shared_ptr<std::string const> message) {
+    auto const ss = std::move(message);
     
     // Post our work to the strand, this ensures that the members of `this` will not be accessed concurrently
     net::post(
@@ -124,8 +246,10 @@ void WebSocketSession::on_read(beast::error_code ec, std::size_t bytes_transferr
 
     // Handle the message
     if(m_message_handler) {
-        std::string message = beast::buffers_to_string(m_buffer.data());
-        m_message_handler(shared_from_this(), message);
+        // Reassigned in place, so after the first few frames this allocates nothing
+        auto data = m_buffer.data();
+        m_message.assign(static_cast<const char*>(data.data()), data.size());
+        m_message_handler(shared_from_this(), m_message);
     }
 
     // Clear the buffer
@@ -160,15 +284,46 @@ void WebSocketSession::on_write(beast::error_code ec, std::size_t bytes_transfer
 EventServer::EventServer() 
     : m_ioc(1)
     , m_acceptor(m_ioc)
+    , m_jitter_rng(std::random_device{}())
+    , m_reminder_jitter(0)
     , m_running(false) {
     
-    m_database = std::make_unique<Database>("events.db");
+    // SQLite tuning preset: durable, balanced (default) or throughput
+    DatabaseProfile profile = DatabaseProfile::Balanced;
+    if (const char* profile_name = std::getenv("DB_PROFILE")) {
+        if (!DatabaseOptions::parse_profile(profile_name, profile)) {
+            std::cerr << "Unknown DB_PROFILE '" << profile_name << "', using balanced" << std::endl;
+        }
+    }
+    m_database = std::make_unique<Database>("events.db", DatabaseOptions::for_profile(profile));
     m_reminderManager = std::make_unique<ReminderManager>(m_database.get());
     m_authManager = std::make_unique<AuthManager>(m_database.get());
     
+    // Optional stateless session tokens shared by every server process
+    if (const char* token_keys = std::getenv("AUTH_TOKEN_KEYS")) {
+        if (m_authManager->enable_signed_tokens(token_keys)) {
+            std::cout << "Signed session tokens enabled" << std::endl;
+        }
+    }
+    
+    // Spread a tick's reminder frames over this many ms so every client
+    // doesn't wake and repaint in the same instant (0: send at once)
+    if (const char* jitter = std::getenv("REMINDER_JITTER_MS")) {
+        m_reminder_jitter = std::chrono::milliseconds(std::max(0, std::atoi(jitter)));
+    }
+    
+    // Record every inbound frame, one per line, for replaying through
+    // bench/parse_mix_bench
+    if (const char* path = std::getenv("RECORD_MESSAGES")) {
+        m_message_log.open(path, std::ios::app);
+        if (!m_message_log) {
+            std::cerr << "Cannot open RECORD_MESSAGES file " << path << std::endl;
+        }
+    }
+    
     // Setup reminder callback
-    m_reminderManager->setReminderCallback([this](const Event& event) {
-        send_reminder(event);
+    m_reminderManager->setReminderCallback([this](const std::vector<EventPtr>& events) {
+        send_reminders(events);
     });
 }
 
@@ -196,6 +351,7 @@ void EventServer::start(int port) {
         m_reminderManager->start();
         
         std::cout << "Event Manager Server started on port " << port << std::endl;
+        std::cout << "Parsing messages with " << Protocol::json_parser() << std::endl;
         
         // Start accepting connections
         do_accept();
@@ -213,6 +369,7 @@ void EventServer::start(int port) {
 void EventServer::stop() {
     if (m_running) {
         m_running = false;
+        m_authManager->flush_last_logins();
         m_reminderManager->stop();
         
         // Close all sessions
@@ -222,6 +379,7 @@ void EventServer::stop() {
                 session->close();
             }
             m_sessions.clear();
+            m_user_sessions.clear();
         }
         
         m_ioc.stop();
@@ -229,6 +387,27 @@ void EventServer::stop() {
         if (m_thread.joinable()) {
             m_thread.join();
         }
+        
+        // exit() on SIGINT skips the destructor that would flush it
+        if (m_message_log.is_open()) {
+            m_message_log.flush();
+        }
+        
+        std::cout << "Database statement statistics:" << std::endl;
+        m_database->log_statement_stats();
+        log_message_allocations();
+    }
+}
+
+void EventServer::log_message_allocations() {
+    if (m_message_allocations.empty()) return;
+    
+    std::cout << "Heap allocations per message (I/O thread):" << std::endl;
+    for (const auto& entry : m_message_allocations) {
+        const MessageAllocations& stats = entry.second;
+        std::cout << "  " << entry.first << ": " << stats.messages << " messages, "
+                  << (static_cast<double>(stats.allocations) / stats.messages) << " allocations / "
+                  << (static_cast<double>(stats.bytes) / stats.messages) << " bytes avg" << std::endl;
     }
 }
 
@@ -281,8 +460,56 @@ void EventServer::on_accept(beast::error_code ec, tcp::socket socket) {
 }
 
 void EventServer::on_message(std::shared_ptr<WebSocketSession> session, const std::string& message) {
+    // Counts the I/O thread's work on the frame itself; database writes and
+    // the broadcasts they trigger run later and aren't charged to it.
+    //
+    // Scratch that dies with the message comes from MessageArena: the SAX
+    // decoder's token buffer, which nlohmann otherwise regrows on the heap
+    // for every parse. A decoded create/update/delete/list still costs 4-7
+    // allocations with simdjson and 13-16 without. The 4-7 are the queued
+    // write, its closures and its completion, which outlive the message.
+    // The other 9 come from nlohmann's token_string and state stack,
+    // std::vectors with std::allocator hard-coded, which no StringType or
+    // AllocatorType reaches. The json DOM of the fallback path stays on
+    // the heap too: Event, EventBatch and Recurrence::from_json take a
+    // plain nlohmann::json. Replies and the decoded strings reuse
+    // per-thread buffers and don't allocate.
+    auto before = AllocationStats::thread_counts();
+    thread_local std::string type;
+    type.clear();
+    {
+        MessageArena::Scope arena;
+        dispatch_message(session, message, type);
+    }
+    
+    if (AllocationStats::enabled()) {
+        auto after = AllocationStats::thread_counts();
+        MessageAllocations& stats = m_message_allocations[type.empty() ? "(unparsed)" : type];
+        ++stats.messages;
+        stats.allocations += after.allocations - before.allocations;
+        stats.bytes += after.bytes - before.bytes;
+    }
+}
+
+void EventServer::dispatch_message(std::shared_ptr<WebSocketSession> session, const std::string& message,
+                                   std::string& type) {
     try {
-        auto [type, data] = Protocol::parse_message(message);
+        if (m_message_log.is_open()) {
+            m_message_log << recorded_frame(message) << '\n';   // flushed by stop()
+        }
+        
+        // Event writes and credentials are decoded in one pass. Other types
+        // are parsed twice, but they are small, and bulk imports and batches
+        // give up at their first array well before the end of the text.
+        thread_local DecodedMessage decoded;
+        if (MessageDecoder::decode(message, decoded) && on_decoded_message(session, decoded)) {
+            type = decoded.type;
+            return;
+        }
+        
+        auto parsed = Protocol::parse_message(message);
+        type = parsed.first;
+        const nlohmann::json& data = parsed.second;
         
         if (type == Protocol::AUTH_LOGIN) {
             handle_auth_login(session, data);
@@ -296,6 +523,10 @@ void EventServer::on_message(std::shared_ptr<WebSocketSession> session, const st
             handle_event_update(session, data);
         } else if (type == Protocol::EVENT_DELETE) {
             handle_event_delete(session, data);
+        } else if (type == Protocol::EVENT_BULK_IMPORT) {
+            handle_event_bulk_import(session, data);
+        } else if (type == Protocol::EVENT_BATCH) {
+            handle_event_batch(session, data);
         } else if (type == Protocol::EVENT_LIST) {
             handle_event_list(session, data);
         }
@@ -305,6 +536,47 @@ void EventServer::on_message(std::shared_ptr<WebSocketSession> session, const st
     }
 }
 
+bool EventServer::on_decoded_message(std::shared_ptr<WebSocketSession> session, const DecodedMessage& message) {
+    const std::string& type = message.type;
+    if (type == Protocol::EVENT_CREATE || type == Protocol::EVENT_UPDATE) {
+        if (message.events.size() != 1) return false;   // let from_json report it
+        if (!is_authenticated(session, message.auth_token)) return true;
+        if (type == Protocol::EVENT_CREATE) {
+            create_event(session, message.events.front(), message.auth_token);
+        } else {
+            update_event(session, message.events.front(), message.auth_token);
+        }
+        return true;
+    }
+    if (type == Protocol::EVENT_DELETE) {
+        if (!message.has_id) return false;
+        if (!is_authenticated(session, message.auth_token)) return true;
+        delete_event(session, message.id, message.version, message.auth_token);
+        return true;
+    }
+    if (type == Protocol::EVENT_LIST) {
+        if (!is_authenticated(session, message.auth_token)) return true;
+        list_events(session, message.has_from && message.has_to,
+                    std::chrono::system_clock::time_point(std::chrono::milliseconds(message.from)),
+                    std::chrono::system_clock::time_point(std::chrono::milliseconds(message.to)));
+        return true;
+    }
+    if (type == Protocol::AUTH_LOGIN) {
+        login_user(session, message.username, message.password);
+        return true;
+    }
+    if (type == Protocol::AUTH_LOGOUT) {
+        logout_user(session, message.auth_token);
+        return true;
+    }
+    if (type == Protocol::AUTH_REGISTER) {
+        register_user(session, message.username, message.email, message.password,
+                      message.has_display_name ? message.display_name : message.username);
+        return true;
+    }
+    return false;
+}
+
 // void EventServer::on_connection_established(std::shared_ptr<WebSocketSession> session) {
 //     // Add to active sessions only after successful handshake
 //     {
@@ -342,6 +614,7 @@ void EventServer::on_connection_established(std::shared_ptr<WebSocketSession> se
 
 
 void EventServer::on_session_close(std::shared_ptr<WebSocketSession> session) {
+    unbind_session_user(session);
     std::lock_guard<std::mutex> lock(m_sessions_lock);
     m_sessions.erase(session);
     std::cout << "Client disconnected. Total active connections: " << m_sessions.size() << std::endl;
@@ -374,19 +647,34 @@ void EventServer::handle_event_create(std::shared_ptr<WebSocketSession> session,
     if (!is_authenticated(session, data)) return;
     
     try {
-        Event event = Event::from_json(data);
-        
+        create_event(session, Event::from_json(data), data["auth_token"]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error creating event: " << e.what() << std::endl;
+    }
+}
+
+void EventServer::create_event(std::shared_ptr<WebSocketSession> session, Event event, const std::string& token) {
+    try {
         // Set user_id from auth token (to track who created it)
-        std::string token = data["auth_token"];
         int user_id = m_authManager->get_user_id_by_token(token);
         event.user_id = user_id;
         
-        int id = m_database->create_event(event);
-        event.id = id;
-        
-        // SHARED CALENDAR: Broadcast new event to ALL connected users
-        broadcast_event_update(event, "created");
-        std::cout << "Event created and broadcast to all users: " << event.title << " (Created by User: " << user_id << ")" << std::endl;
+        // Group-committed with other pending writes; the broadcast is posted
+        // back to the I/O thread only after the batch has committed, and
+        // sends the stored row (with its id and version)
+        m_database->create_event_async(std::move(event), [this, session, user_id](EventPtr created) {
+            net::post(m_ioc, [this, session, user_id, created]() {
+                if (!created) {
+                    std::cerr << "Failed to create event (User: " << user_id << ")" << std::endl;
+                    send_event_error(session, 0, WriteResult::Failed, false);
+                    return;
+                }
+                
+                // SHARED CALENDAR: Broadcast new event to ALL connected users
+                broadcast_event_update(*created, "created");
+                std::cout << "Event created and broadcast to all users: " << created->title << " (Created by User: " << user_id << ")" << std::endl;
+            });
+        });
         
     } catch (const std::exception& e) {
         std::cerr << "Error creating event: " << e.what() << std::endl;
@@ -433,32 +721,33 @@ void EventServer::handle_event_update(std::shared_ptr<WebSocketSession> session,
     if (!is_authenticated(session, data)) return;
     
     try {
-        Event event = Event::from_json(data);
-        
+        update_event(session, Event::from_json(data), data["auth_token"]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error updating event: " << e.what() << std::endl;
+    }
+}
+
+void EventServer::update_event(std::shared_ptr<WebSocketSession> session, const Event& event, const std::string& token) {
+    try {
         // Get current user from token
-        std::string token = data["auth_token"];
         int user_id = m_authManager->get_user_id_by_token(token);
         
-        // OPTIONAL: Check if user owns this event (for edit permissions)
-        Event existing_event = m_database->get_event_by_id(event.id);
-        if (existing_event.user_id != user_id) {
-            nlohmann::json error_response = {
-                {"error", "You can only modify your own events"},
-                {"code", "PERMISSION_DENIED"}
-            };
-            auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-            session->send(message.dump());
-            return;
-        }
-        
-        event.user_id = user_id; // Ensure user_id is set
-        bool success = m_database->update_event(event);
-        
-        if (success) {
-            // SHARED CALENDAR: Broadcast update to ALL connected users
-            broadcast_event_update(event, "updated");
-            std::cout << "Event updated and broadcast to all users: " << event.title << " (Updated by User: " << user_id << ")" << std::endl;
-        }
+        // Ownership and version are checked by the UPDATE itself; edits that
+        // change nothing are neither written nor broadcast
+        int event_id = event.id;
+        m_database->update_owned_event_async(event, user_id,
+            [this, session, event_id, user_id](WriteResult result, EventPtr current) {
+                // `current` is the same immutable object the store now holds
+                net::post(m_ioc, [this, session, event_id, user_id, result, current]() {
+                    if (result == WriteResult::Applied) {
+                        // SHARED CALENDAR: Broadcast update to ALL connected users
+                        broadcast_event_update(*current, "updated");
+                        std::cout << "Event updated and broadcast to all users: " << current->title << " (Updated by User: " << user_id << ")" << std::endl;
+                    } else if (result != WriteResult::Unchanged) {
+                        send_event_error(session, event_id, result, false, current ? *current : Event());
+                    }
+                });
+            });
         
     } catch (const std::exception& e) {
         std::cerr << "Error updating event: " << e.what() << std::endl;
@@ -506,30 +795,37 @@ void EventServer::handle_event_delete(std::shared_ptr<WebSocketSession> session,
     
     try {
         int event_id = data["id"];
-        std::string token = data["auth_token"];
+        int expected_version = data.contains("version") ? data["version"].get<int>() : 0;
+        delete_event(session, event_id, expected_version, data["auth_token"].get_ref<const std::string&>());
+    } catch (const std::exception& e) {
+        std::cerr << "Error deleting event: " << e.what() << std::endl;
+    }
+}
+
+void EventServer::delete_event(std::shared_ptr<WebSocketSession> session, int event_id, int expected_version,
+                               const std::string& token) {
+    try {
         int user_id = m_authManager->get_user_id_by_token(token);
         
-        // OPTIONAL: Check if user owns this event (for delete permissions)
-        Event existing_event = m_database->get_event_by_id(event_id);
-        if (existing_event.user_id != user_id) {
-            nlohmann::json error_response = {
-                {"error", "You can only delete your own events"},
-                {"code", "PERMISSION_DENIED"}
-            };
-            auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-            session->send(message.dump());
-            return;
-        }
-        
-        bool success = m_database->delete_event(event_id);
-        
-        if (success) {
-            // SHARED CALENDAR: Broadcast deletion to ALL connected users
-            nlohmann::json delete_data = {{"id", event_id}};
-            auto message = Protocol::create_message(Protocol::EVENT_DELETE, delete_data);
-            broadcast_to_all(message.dump());
-            std::cout << "Event deleted and broadcast to all users: " << event_id << " (Deleted by User: " << user_id << ")" << std::endl;
-        }
+        m_database->delete_owned_event_async(event_id, user_id, expected_version,
+            [this, session, event_id, user_id](WriteResult result) {
+                net::post(m_ioc, [this, session, event_id, user_id, result]() {
+                    if (result != WriteResult::Applied) {
+                        send_event_error(session, event_id, result, true);
+                        return;
+                    }
+                    // SHARED CALENDAR: Broadcast deletion to ALL connected users
+                    std::string& message = message_buffer();
+                    Protocol::write_message(message, Protocol::EVENT_DELETE, [&](JsonWriter& writer) {
+                        writer.begin_object();
+                        writer.key("id");
+                        writer.value(event_id);
+                        writer.end_object();
+                    });
+                    broadcast_to_all(message);
+                    std::cout << "Event deleted and broadcast to all users: " << event_id << " (Deleted by User: " << user_id << ")" << std::endl;
+                });
+            });
         
     } catch (const std::exception& e) {
         std::cerr << "Error deleting event: " << e.what() << std::endl;
@@ -563,43 +859,342 @@ void EventServer::handle_event_delete(std::shared_ptr<WebSocketSession> session,
 void EventServer::handle_event_list(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data) {
     if (!is_authenticated(session, data)) return;
     
+    try {
+        // Optional window [from, to) in ms: recurring events are then
+        // expanded into the "occurrences" that fall inside it. Without one,
+        // every event is listed once with its rule.
+        bool windowed = data.contains("from") && data.contains("to") &&
+                        data["from"].is_number_integer() && data["to"].is_number_integer();
+        std::chrono::system_clock::time_point from, to;
+        if (windowed) {
+            from = std::chrono::system_clock::time_point(std::chrono::milliseconds(data["from"].get<int64_t>()));
+            to = std::chrono::system_clock::time_point(std::chrono::milliseconds(data["to"].get<int64_t>()));
+        }
+        list_events(session, windowed, from, to);
+    } catch (const std::exception& e) {
+        std::cerr << "Error listing events: " << e.what() << std::endl;
+    }
+}
+
+void EventServer::list_events(std::shared_ptr<WebSocketSession> session, bool windowed,
+                              std::chrono::system_clock::time_point from,
+                              std::chrono::system_clock::time_point to) {
     try {
         // SHARED CALENDAR: Show ALL events to authenticated users
-        auto events = m_database->get_all_events();
-        nlohmann::json events_json = nlohmann::json::array();
+        // (shared pointers into the event store, no row copies, streamed
+        // straight into the message text)
+        auto events = windowed ? m_database->list_events_between(from, to) : m_database->list_events();
+        std::string& message = message_buffer();
+        Protocol::write_message(message, Protocol::EVENT_LIST, [&](JsonWriter& writer) {
+            writer.begin_array();
+            for (const auto& event : events) {
+                if (!windowed || !event->recurrence.is_recurring()) {
+                    event->write_json(writer);
+                    continue;
+                }
+                event->write_json(writer, {{"occurrences", [&](JsonWriter& writer) {
+                    writer.begin_array();
+                    for (const auto& start : event->recurrence.occurrences_between(event->event_time, from, to)) {
+                        writer.value(epoch_ms(start));
+                    }
+                    writer.end_array();
+                }}});
+            }
+            writer.end_array();
+        });
+        session->send(message);
         
-        for (const auto& event : events) {
-            events_json.push_back(event.to_json());
+        std::cout << "Sent " << events.size() << " events to authenticated user" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error listing events: " << e.what() << std::endl;
+    }
+}
+
+void EventServer::handle_event_bulk_import(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data) {
+    if (!is_authenticated(session, data)) return;
+    
+    try {
+        std::string token = data["auth_token"];
+        int user_id = m_authManager->get_user_id_by_token(token);
+        
+        BulkFormat format = BulkFormat::NDJSON;
+        if (data.contains("format") && !BulkIO::parse_format(data["format"], format)) {
+            nlohmann::json error_response = {
+                {"error", "Unsupported format (use ndjson or csv)"},
+                {"code", "BULK_IMPORT_FAILED"}
+            };
+            auto message = Protocol::create_message(Protocol::EVENT_BULK_IMPORT, error_response);
+            session->send(message.dump());
+            return;
         }
         
-        auto message = Protocol::create_message(Protocol::EVENT_LIST, events_json);
-        session->send(message.dump());
+        // Parse the whole payload up front; the good lines go in as one
+        // transaction and bad ones are reported back by line number. Lines
+        // are views into the payload, not copies.
+        std::string_view payload = data["payload"].get_ref<const std::string&>();
+        BulkIO::EventReader reader(format);
+        std::vector<Event> events;
+        nlohmann::json errors = nlohmann::json::array();
+        size_t rejected = 0;
+        size_t line_number = 0;
+        size_t start = 0;
         
-        std::cout << "Sent " << events.size() << " events to authenticated user" << std::endl;
+        while (start < payload.size()) {
+            size_t end = payload.find('\n', start);
+            if (end == std::string_view::npos) end = payload.size();
+            ++line_number;
+            
+            Event event;
+            bool has_event = false;
+            std::string error;
+            if (!reader.parse_line(payload.substr(start, end - start), event, has_event, error)) {
+                ++rejected;
+                if (errors.size() < 20) {
+                    errors.push_back({{"line", line_number}, {"error", error}});
+                }
+            } else if (has_event) {
+                // Imported events always belong to the importing user
+                event.user_id = user_id;
+                events.push_back(std::move(event));
+            }
+            start = end + 1;
+        }
+        
+        // As with event_batch, every session learns of a committed import
+        // from one frame: the imported events as create operations
+        size_t parsed = events.size();
+        m_database->import_events_async(std::move(events),
+            [this, session, user_id, parsed, rejected, errors](bool committed, const std::vector<EventPtr>& imported) {
+                net::post(m_ioc, [this, session, user_id, parsed, rejected, errors, committed, imported]() {
+                    nlohmann::json result = {
+                        {"imported", imported.size()},
+                        {"rejected", rejected},
+                        {"errors", errors}
+                    };
+                    if (!committed) {
+                        result["error"] = "Import failed; no events were added";
+                        result["code"] = "BULK_IMPORT_FAILED";
+                    }
+                    auto message = Protocol::create_message(Protocol::EVENT_BULK_IMPORT, result);
+                    session->send(message.dump());
+                    
+                    if (!imported.empty()) {
+                        std::string& batch = message_buffer();
+                        Protocol::write_message(batch, Protocol::EVENT_BATCH, [&](JsonWriter& writer) {
+                            writer.begin_object();
+                            writer.key("operations");
+                            writer.begin_array();
+                            for (const auto& event : imported) {
+                                writer.begin_object();
+                                writer.key("event");
+                                event->write_json(writer);
+                                writer.key("op");
+                                writer.value("create");
+                                writer.end_object();
+                            }
+                            writer.end_array();
+                            writer.key("user_id");
+                            writer.value(user_id);
+                            writer.end_object();
+                        });
+                        broadcast_to_all(batch);
+                    }
+                    std::cout << "Bulk import by User " << user_id << ": " << imported.size()
+                              << " of " << parsed << " events (" << rejected << " rejected)" << std::endl;
+                });
+            });
         
     } catch (const std::exception& e) {
-        std::cerr << "Error listing events: " << e.what() << std::endl;
+        std::cerr << "Error importing events: " << e.what() << std::endl;
+    }
+}
+
+void EventServer::handle_event_batch(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data) {
+    if (!is_authenticated(session, data)) return;
+    
+    // Keeps one batch from holding the writer for too long
+    const size_t kMaxBatchOperations = 1000;
+    
+    try {
+        std::string token = data["auth_token"];
+        int user_id = m_authManager->get_user_id_by_token(token);
+        
+        const nlohmann::json& items = data["operations"];
+        if (!items.is_array() || items.empty() || items.size() > kMaxBatchOperations) {
+            nlohmann::json error_response = {
+                {"error", "operations must be a non-empty array of at most " +
+                          std::to_string(kMaxBatchOperations) + " entries"},
+                {"code", "BATCH_REJECTED"},
+                {"committed", false},
+                {"results", nlohmann::json::array()}
+            };
+            auto message = Protocol::create_message(Protocol::EVENT_BATCH, error_response);
+            session->send(message.dump());
+            return;
+        }
+        
+        // Parse every operation before writing anything; one malformed entry
+        // rejects the whole batch. Ownership and versions are checked by the
+        // conditional statements inside the batch transaction.
+        std::vector<EventOperation> operations(items.size());
+        nlohmann::json results = nlohmann::json::array();
+        bool valid = true;
+        
+        for (size_t i = 0; i < items.size(); ++i) {
+            EventOperation& operation = operations[i];
+            std::string error;
+            
+            bool parsed = EventOperation::from_json(items[i], operation, error);
+            
+            nlohmann::json result = {{"index", i}, {"ok", error.empty()}};
+            if (parsed) {
+                result["op"] = EventOperation::type_name(operation.type);
+            } else if (items[i].is_object() && items[i].contains("op")) {
+                result["op"] = items[i]["op"];
+            }
+            if (!error.empty()) {
+                result["error"] = error;
+                valid = false;
+            }
+            results.push_back(result);
+        }
+        
+        if (!valid) {
+            for (auto& result : results) {
+                result["ok"] = false;
+            }
+            nlohmann::json response = {
+                {"error", "Batch rejected; no changes were made"},
+                {"code", "BATCH_REJECTED"},
+                {"committed", false},
+                {"results", results}
+            };
+            auto message = Protocol::create_message(Protocol::EVENT_BATCH, response);
+            session->send(message.dump());
+            return;
+        }
+        
+        // One write task = one transaction; on commit every session gets a
+        // single event_batch frame instead of one broadcast per operation
+        m_database->apply_event_batch_async(std::move(operations), user_id,
+            [this, session, user_id, results](bool committed, const std::vector<EventOperation>& applied,
+                                              size_t failed_at, WriteResult failure) {
+                net::post(m_ioc, [this, session, user_id, results, committed, applied, failed_at, failure]() mutable {
+                    for (size_t i = 0; i < results.size(); ++i) {
+                        results[i]["ok"] = committed;
+                        if (committed && applied[i].type != EventOperation::Delete) {
+                            results[i]["id"] = applied[i].event.id;
+                            results[i]["version"] = applied[i].event.version;
+                        } else if (!committed && i == failed_at) {
+                            results[i]["error"] = write_result_message(failure, applied[i].type == EventOperation::Delete);
+                            results[i]["code"] = write_result_code(failure);
+                        }
+                    }
+                    
+                    nlohmann::json response = {{"committed", committed}, {"results", results}};
+                    if (!committed) {
+                        response["error"] = "Batch rolled back; no changes were made";
+                        response["code"] = "BATCH_FAILED";
+                    }
+                    session->send(Protocol::create_message(Protocol::EVENT_BATCH, response).dump());
+                    
+                    if (committed) {
+                        nlohmann::json batch_data = {{"operations", EventBatch::to_json(applied)}, {"user_id", user_id}};
+                        broadcast_to_all(Protocol::create_message(Protocol::EVENT_BATCH, batch_data).dump());
+                    }
+                    std::cout << "Event batch by User " << user_id << ": " << applied.size() << " operations "
+                              << (committed ? "committed and broadcast" : "rolled back") << std::endl;
+                });
+            });
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error applying event batch: " << e.what() << std::endl;
     }
 }
 
+void EventServer::send_event_error(std::shared_ptr<WebSocketSession> session, int event_id, WriteResult result,
+                                   bool is_delete, const Event& current) {
+    std::string& message = message_buffer();
+    Protocol::write_message(message, Protocol::EVENT_ERROR, [&](JsonWriter& writer) {
+        writer.begin_object();
+        writer.key("code");
+        writer.value(write_result_code(result));
+        writer.key("error");
+        writer.value(write_result_message(result, is_delete));
+        // Lets the client replace its stale copy without a full reload
+        if (result == WriteResult::Conflict && current.id != 0) {
+            writer.key("event");
+            current.write_json(writer);
+        }
+        writer.key("id");
+        writer.value(event_id);
+        writer.end_object();
+    });
+    session->send(message);
+}
+
 void EventServer::broadcast_to_all(const std::string& message) {
+    auto shared = std::make_shared<std::string const>(message);
     std::lock_guard<std::mutex> lock(m_sessions_lock);
     
     for (auto& session : m_sessions) {
         try {
-            session->send(message);
+            session->send(shared);
         } catch (const std::exception& e) {
             std::cerr << "Error broadcasting message: " << e.what() << std::endl;
         }
     }
 }
 
-void EventServer::broadcast_event_update(const Event& event, const std::string& action) {
-    nlohmann::json data = event.to_json();
-    data["action"] = action;
+void EventServer::bind_session_user(const std::shared_ptr<WebSocketSession>& session, int user_id) {
+    std::lock_guard<std::mutex> lock(m_sessions_lock);
+    int previous = session->user_id();
+    if (previous == user_id) return;
     
-    auto message = Protocol::create_message(Protocol::EVENT_UPDATE, data);
-    broadcast_to_all(message.dump());
+    if (previous != 0) {
+        auto& sessions = m_user_sessions[previous];
+        sessions.erase(std::remove(sessions.begin(), sessions.end(), session), sessions.end());
+        if (sessions.empty()) m_user_sessions.erase(previous);
+    }
+    if (user_id != 0) {
+        m_user_sessions[user_id].push_back(session);
+    }
+    session->set_user_id(user_id);
+}
+
+void EventServer::unbind_session_user(const std::shared_ptr<WebSocketSession>& session) {
+    bind_session_user(session, 0);
+}
+
+void EventServer::send_spread(const std::vector<std::shared_ptr<WebSocketSession>>& sessions,
+                              const std::string& message, std::chrono::milliseconds jitter) {
+    auto shared = std::make_shared<std::string const>(message);
+    if (jitter.count() <= 0) {
+        for (const auto& session : sessions) {
+            session->send(shared);
+        }
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_sessions_lock);
+    std::uniform_int_distribution<long> delay_ms(0, static_cast<long>(jitter.count()));
+    for (const auto& session : sessions) {
+        auto timer = std::make_shared<net::steady_timer>(m_ioc, std::chrono::milliseconds(delay_ms(m_jitter_rng)));
+        timer->async_wait([timer, session, shared](beast::error_code ec) {
+            if (!ec) {
+                session->send(shared);
+            }
+        });
+    }
+}
+
+void EventServer::broadcast_event_update(const Event& event, const std::string& action) {
+    std::string& message = message_buffer();
+    Protocol::write_message(message, Protocol::EVENT_UPDATE, [&](JsonWriter& writer) {
+        event.write_json(writer, {{"action", [&](JsonWriter& writer) { writer.value(action); }}});
+    });
+    broadcast_to_all(message);
 }
 
 // void EventServer::send_reminder(const Event& event) {
@@ -611,133 +1206,161 @@ void EventServer::broadcast_event_update(const Event& event, const std::string&
 //     broadcast_to_all(message.dump());
 // }
 
-void EventServer::send_reminder(const Event& event) {
-    nlohmann::json reminder_data = event.to_json();
-    reminder_data["message"] = "Reminder: " + event.title + " starts in " + 
-                             std::to_string(event.time_until_event().count()) + " minutes";
+void EventServer::send_reminders(const std::vector<EventPtr>& events) {
+    if (events.empty()) return;
     
-    auto message = Protocol::create_message(Protocol::REMINDER, reminder_data);
+    auto write_reminder = [](JsonWriter& writer, const Event& event) {
+        std::string text = "Reminder: " + event.title + " starts in " +
+                           std::to_string(event.time_until_event().count()) + " minutes";
+        event.write_json(writer, {{"message", [&](JsonWriter& writer) { writer.value(text); }}});
+    };
+    
+    std::unordered_map<int, std::vector<const Event*>> by_owner;
+    for (const auto& event : events) {
+        by_owner[event->user_id].push_back(event.get());
+    }
+    
+    size_t delivered = 0;
+    for (const auto& owner : by_owner) {
+        std::vector<std::shared_ptr<WebSocketSession>> recipients;
+        {
+            std::lock_guard<std::mutex> lock(m_sessions_lock);
+            auto it = m_user_sessions.find(owner.first);
+            if (it != m_user_sessions.end()) {
+                recipients = it->second;
+            }
+        }
+        // Not signed in anywhere: nothing to serialize
+        if (recipients.empty()) continue;
+        
+        const auto& owned = owner.second;
+        std::string& message = message_buffer();
+        if (owned.size() == 1) {
+            Protocol::write_message(message, Protocol::REMINDER, [&](JsonWriter& writer) {
+                write_reminder(writer, *owned.front());
+            });
+        } else {
+            Protocol::write_message(message, Protocol::REMINDER_BATCH, [&](JsonWriter& writer) {
+                writer.begin_object();
+                writer.key("reminders");
+                writer.begin_array();
+                for (const Event* event : owned) {
+                    write_reminder(writer, *event);
+                }
+                writer.end_array();
+                writer.end_object();
+            });
+        }
+        send_spread(recipients, message, m_reminder_jitter);
+        delivered += recipients.size();
+    }
     
-    // SHARED REMINDERS: Send reminder to ALL authenticated users
-    broadcast_to_all(message.dump());
-    std::cout << "Reminder sent to all users for event: " << event.title << std::endl;
+    std::cout << "Reminders for " << events.size() << " event(s) sent to " << delivered
+              << " session(s) of " << by_owner.size() << " owner(s)" << std::endl;
 }
 
 // Authentication methods
 bool EventServer::is_authenticated(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data) {
-    if (!data.contains("auth_token")) {
-        nlohmann::json error_response = {
-            {"error", "Authentication required"},
-            {"code", "AUTH_REQUIRED"}
-        };
-        auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-        session->send(message.dump());
+    static const std::string no_token;
+    auto token = data.find("auth_token");
+    return is_authenticated(session, token != data.end() ? token->get_ref<const std::string&>() : no_token);
+}
+
+bool EventServer::is_authenticated(std::shared_ptr<WebSocketSession> session, const std::string& token) {
+    if (token.empty()) {
+        send_error(session, Protocol::AUTH_ERROR, "AUTH_REQUIRED", "Authentication required");
         return false;
     }
     
-    std::string token = data["auth_token"];
     if (!m_authManager->validate_token(token)) {
-        nlohmann::json error_response = {
-            {"error", "Invalid or expired token"},
-            {"code", "INVALID_TOKEN"}
-        };
-        auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-        session->send(message.dump());
+        send_error(session, Protocol::AUTH_ERROR, "INVALID_TOKEN", "Invalid or expired token");
         return false;
     }
     
+    // A reconnect reuses its token without logging in again
+    if (session->user_id() == 0) {
+        bind_session_user(session, m_authManager->get_user_id_by_token(token));
+    }
+    
     return true;
 }
 
 void EventServer::handle_auth_login(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data) {
+    login_user(session, data.value("username", ""), data.value("password", ""));
+}
+
+void EventServer::login_user(std::shared_ptr<WebSocketSession> session, const std::string& username,
+                             const std::string& password) {
     try {
-        std::string username = data["username"];
-        std::string password = data["password"];
-        
         AuthToken token = m_authManager->login(username, password);
         
         if (token.token.empty()) {
-            nlohmann::json error_response = {
-                {"error", "Invalid username or password"},
-                {"code", "INVALID_CREDENTIALS"}
-            };
-            auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-            session->send(message.dump());
+            send_error(session, Protocol::AUTH_ERROR, "INVALID_CREDENTIALS", "Invalid username or password");
             return;
         }
         
-        // Get user info
-        User user = m_authManager->get_user_by_token(token.token);
+        // Get user info (served from the user directory, no database read)
+        User user = m_authManager->get_user_by_id(token.user_id);
         
-        nlohmann::json success_response = {
-            {"token", token.token},
-            {"user", user.to_json()}
-        };
-        auto message = Protocol::create_message(Protocol::AUTH_SUCCESS, success_response);
-        session->send(message.dump());
+        std::string& message = message_buffer();
+        Protocol::write_message(message, Protocol::AUTH_SUCCESS, [&](JsonWriter& writer) {
+            writer.begin_object();
+            writer.key("token");
+            writer.value(token.token);
+            writer.key("user");
+            Schema::write_json(writer, user);
+            writer.end_object();
+        });
+        session->send(message);
+        bind_session_user(session, token.user_id);
         
         std::cout << "User " << username << " logged in successfully" << std::endl;
         
     } catch (const std::exception& e) {
         std::cerr << "Login error: " << e.what() << std::endl;
-        nlohmann::json error_response = {
-            {"error", "Login failed"},
-            {"code", "LOGIN_ERROR"}
-        };
-        auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-        session->send(message.dump());
+        send_error(session, Protocol::AUTH_ERROR, "LOGIN_ERROR", "Login failed");
     }
 }
 
 void EventServer::handle_auth_register(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data) {
+    std::string username = data.value("username", "");
+    register_user(session, username, data.value("email", ""), data.value("password", ""),
+                  data.value("display_name", username));
+}
+
+void EventServer::register_user(std::shared_ptr<WebSocketSession> session, const std::string& username,
+                                const std::string& email, const std::string& password,
+                                const std::string& display_name) {
     try {
-        std::string username = data["username"];
-        std::string email = data["email"];
-        std::string password = data["password"];
-        std::string display_name = data.contains("display_name") ? data["display_name"].get<std::string>() : username;
-        
         bool success = m_authManager->register_user(username, email, password, display_name);
         
         if (success) {
-            nlohmann::json success_response = {
-                {"message", "User registered successfully"}
-            };
-            auto message = Protocol::create_message(Protocol::AUTH_SUCCESS, success_response);
-            session->send(message.dump());
-            
+            send_notice(session, Protocol::AUTH_SUCCESS, "User registered successfully");
             std::cout << "User " << username << " registered successfully" << std::endl;
         } else {
-            nlohmann::json error_response = {
-                {"error", "Registration failed. Username or email may already exist."},
-                {"code", "REGISTRATION_FAILED"}
-            };
-            auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-            session->send(message.dump());
+            send_error(session, Protocol::AUTH_ERROR, "REGISTRATION_FAILED",
+                       "Registration failed. Username or email may already exist.");
         }
         
     } catch (const std::exception& e) {
         std::cerr << "Registration error: " << e.what() << std::endl;
-        nlohmann::json error_response = {
-            {"error", "Registration failed"},
-            {"code", "REGISTRATION_ERROR"}
-        };
-        auto message = Protocol::create_message(Protocol::AUTH_ERROR, error_response);
-        session->send(message.dump());
+        send_error(session, Protocol::AUTH_ERROR, "REGISTRATION_ERROR", "Registration failed");
     }
 }
 
 void EventServer::handle_auth_logout(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data) {
+    static const std::string no_token;
+    auto token = data.find("auth_token");
+    logout_user(session, token != data.end() ? token->get_ref<const std::string&>() : no_token);
+}
+
+void EventServer::logout_user(std::shared_ptr<WebSocketSession> session, const std::string& token) {
     try {
-        if (data.contains("auth_token")) {
-            std::string token = data["auth_token"];
+        if (!token.empty()) {
             m_authManager->logout(token);
         }
-        
-        nlohmann::json success_response = {
-            {"message", "Logged out successfully"}
-        };
-        auto message = Protocol::create_message(Protocol::AUTH_SUCCESS, success_response);
-        session->send(message.dump());
+        unbind_session_user(session);
+        send_notice(session, Protocol::AUTH_SUCCESS, "Logged out successfully");
         
     } catch (const std::exception& e) {
         std::cerr << "Logout error: " << e.what() << std::endl;
@@ -4,17 +4,25 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <nlohmann/json.hpp>
+#include <chrono>
 #include <memory>
+#include <random>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <set>
+#include <unordered_map>
+#include <atomic>
+#include <fstream>
+#include <map>
 #include "Database.h"
 #include "ReminderManager.h"
 #include "AuthManager.h"
 #include "Event.h"
+#include "MessageDecoder.h"
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -29,8 +37,14 @@ public:
     
     void run();
     void send(const std::string& message);
+    // Shares one serialized frame between every session it is queued on
+    void send(std::shared_ptr<std::string const> message);
     void close();
     
+    // User this connection is signed in as (0: none); kept by EventServer
+    int user_id() const { return m_user_id.load(std::memory_order_relaxed); }
+    void set_user_id(int user_id) { m_user_id.store(user_id, std::memory_order_relaxed); }
+    
     void set_message_handler(std::function<void(std::shared_ptr<WebSocketSession>, const std::string&)> handler);
     void set_close_handler(std::function<void(std::shared_ptr<WebSocketSession>)> handler);
     void set_connect_handler(std::function<void(std::shared_ptr<WebSocketSession>)> handler);
@@ -43,7 +57,9 @@ private:
 
     websocket::stream<beast::tcp_stream> m_ws;
     beast::flat_buffer m_buffer;
+    std::string m_message;   // the frame being handled, reused across reads
     std::vector<std::shared_ptr<std::string const>> m_queue;
+    std::atomic<int> m_user_id{0};
     
     std::function<void(std::shared_ptr<WebSocketSession>, const std::string&)> m_message_handler;
     std::function<void(std::shared_ptr<WebSocketSession>)> m_close_handler;
@@ -63,6 +79,12 @@ private:
     void on_accept(beast::error_code ec, tcp::socket socket);
     
     void on_message(std::shared_ptr<WebSocketSession> session, const std::string& message);
+    // Decodes and handles one frame; `type` is set once it is known
+    void dispatch_message(std::shared_ptr<WebSocketSession> session, const std::string& message,
+                          std::string& type);
+    // Handles what MessageDecoder produced; false leaves the message to the
+    // json path
+    bool on_decoded_message(std::shared_ptr<WebSocketSession> session, const DecodedMessage& message);
     void on_session_close(std::shared_ptr<WebSocketSession> session);
     void on_connection_established(std::shared_ptr<WebSocketSession> session);
     
@@ -71,19 +93,56 @@ private:
     void handle_event_update(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
     void handle_event_delete(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
     void handle_event_list(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
+    void handle_event_bulk_import(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
+    void handle_event_batch(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
     
     // Authentication handlers
     void handle_auth_login(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
     void handle_auth_register(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
     void handle_auth_logout(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
     
+    // What the handlers above do once their input is out of the json (or
+    // came from MessageDecoder); `token` is already authenticated, except
+    // for logout
+    void create_event(std::shared_ptr<WebSocketSession> session, Event event, const std::string& token);
+    void update_event(std::shared_ptr<WebSocketSession> session, const Event& event, const std::string& token);
+    void delete_event(std::shared_ptr<WebSocketSession> session, int event_id, int expected_version,
+                      const std::string& token);
+    // windowed: expand recurring events over [from, to)
+    void list_events(std::shared_ptr<WebSocketSession> session, bool windowed,
+                     std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to);
+    void login_user(std::shared_ptr<WebSocketSession> session, const std::string& username,
+                    const std::string& password);
+    void register_user(std::shared_ptr<WebSocketSession> session, const std::string& username,
+                       const std::string& email, const std::string& password, const std::string& display_name);
+    // Empty token = none given
+    void logout_user(std::shared_ptr<WebSocketSession> session, const std::string& token);
+    
+    // user_id -> sessions index for targeted sends; a session belongs to
+    // at most one user and is bound on login or its first authenticated
+    // request, unbound on logout and close
+    void bind_session_user(const std::shared_ptr<WebSocketSession>& session, int user_id);
+    void unbind_session_user(const std::shared_ptr<WebSocketSession>& session);
+    
     // Broadcast functions
     void broadcast_to_all(const std::string& message);
+    // Each session's copy is queued after its own random 0..jitter delay
+    void send_spread(const std::vector<std::shared_ptr<WebSocketSession>>& sessions,
+                     const std::string& message, std::chrono::milliseconds jitter);
     void broadcast_event_update(const Event& event, const std::string& action);
-    void send_reminder(const Event& event);
+    void send_event_error(std::shared_ptr<WebSocketSession> session, int event_id, WriteResult result,
+                          bool is_delete, const Event& current = Event());
+    // Reminders go to the owner's sessions only, one frame per user per
+    // tick: "reminder" for a single event, else "reminder_batch"
+    void send_reminders(const std::vector<EventPtr>& events);
+    
+    // COUNT_ALLOCATIONS builds: average heap allocations per message type
+    void log_message_allocations();
     
     // Authentication helper
     bool is_authenticated(std::shared_ptr<WebSocketSession> session, const nlohmann::json& data);
+    // Empty token = none given
+    bool is_authenticated(std::shared_ptr<WebSocketSession> session, const std::string& token);
 
     net::io_context m_ioc;
     tcp::acceptor m_acceptor;
@@ -93,6 +152,17 @@ private:
     std::thread m_thread;
     std::mutex m_sessions_lock;
     std::set<std::shared_ptr<WebSocketSession>> m_sessions;
+    std::unordered_map<int, std::vector<std::shared_ptr<WebSocketSession>>> m_user_sessions;
+    std::minstd_rand m_jitter_rng;  // guarded by m_sessions_lock
+    std::chrono::milliseconds m_reminder_jitter;
+    std::ofstream m_message_log;   // RECORD_MESSAGES: inbound frames, one per line, credentials masked
+    
+    struct MessageAllocations {
+        uint64_t messages = 0;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+    };
+    std::map<std::string, MessageAllocations> m_message_allocations;   // I/O thread only
     bool m_running;
 };
 
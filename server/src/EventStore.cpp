@@ -0,0 +1,182 @@
+#include "EventStore.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+namespace {
+
+int64_t epoch_ms(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+EventStore::EventStore() {
+}
+
+void EventStore::clear(size_t expected) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_by_id.clear();
+    m_by_time.clear();
+    m_by_user.clear();
+    m_columns.clear();
+    m_recurring.clear();
+    m_pending.clear();
+    m_by_id.reserve(expected);
+    m_columns.reserve(expected);
+}
+
+void EventStore::publish(const std::vector<std::pair<int, EventPtr>>& changes) {
+    if (changes.empty()) return;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (const auto& change : changes) {
+        erase_locked(change.first);
+        if (change.second) {
+            insert_locked(change.second);
+        }
+    }
+}
+
+EventPtr EventStore::find(int id) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_by_id.find(id);
+    return it == m_by_id.end() ? nullptr : it->second;
+}
+
+std::vector<EventPtr> EventStore::all() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<EventPtr> events;
+    events.reserve(m_by_time.size());
+    for (const auto& key : m_by_time) {
+        events.push_back(m_by_id.at(key.second));
+    }
+    return events;
+}
+
+std::vector<EventPtr> EventStore::for_user(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<EventPtr> events;
+    auto user = m_by_user.find(user_id);
+    if (user == m_by_user.end()) return events;
+
+    events.reserve(user->second.size());
+    for (const auto& key : user->second) {
+        events.push_back(m_by_id.at(key.second));
+    }
+    return events;
+}
+
+std::vector<EventPtr> EventStore::pending_reminders() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<uint32_t> rows;
+    m_columns.select_pending_reminders(std::numeric_limits<int64_t>::max(), rows);
+    return collect_locked(rows, true, m_recurring);
+}
+
+std::vector<EventPtr> EventStore::due_reminders(std::chrono::system_clock::time_point now, size_t limit,
+                                                std::vector<int>& stale) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<EventPtr> events;
+    for (auto it = m_pending.begin();
+         it != m_pending.end() && it->first <= now && events.size() + stale.size() < limit; ++it) {
+        const EventPtr& event = m_by_id.at(it->second);
+        // Started before its reminder went out (e.g. the server was down):
+        // never due, and left for the caller to retire
+        if (event->event_time > now) {
+            events.push_back(event);
+        } else {
+            stale.push_back(event->id);
+        }
+    }
+    return events;
+}
+
+std::vector<EventPtr> EventStore::between(std::chrono::system_clock::time_point from,
+                                          std::chrono::system_clock::time_point to) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<uint32_t> rows;
+    m_columns.select_in_window(epoch_ms(from), epoch_ms(to), rows);
+    return collect_locked(rows, false, {});
+}
+
+size_t EventStore::count_between(std::chrono::system_clock::time_point from,
+                                 std::chrono::system_clock::time_point to) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_columns.count_in_window(epoch_ms(from), epoch_ms(to));
+}
+
+std::vector<EventPtr> EventStore::recurring_before(std::chrono::system_clock::time_point to) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<EventPtr> events;
+    for (auto it = m_recurring.begin(); it != m_recurring.end() && it->first < to; ++it) {
+        events.push_back(m_by_id.at(it->second));
+    }
+    return events;
+}
+
+size_t EventStore::size() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_by_id.size();
+}
+
+void EventStore::insert_locked(EventPtr event) {
+    const Event& e = *event;
+    m_by_time.emplace(e.event_time, e.id);
+    m_by_user[e.user_id].emplace(e.event_time, e.id);
+    if (e.recurrence.is_recurring()) {
+        m_recurring.emplace(e.event_time, e.id);
+    } else {
+        m_columns.upsert(e);
+        if (!e.reminder_sent) {
+            m_pending.emplace(e.reminder_time, e.id);
+        }
+    }
+    m_by_id[e.id] = std::move(event);
+}
+
+void EventStore::erase_locked(int id) {
+    auto it = m_by_id.find(id);
+    if (it == m_by_id.end()) return;
+
+    const Event& e = *it->second;
+    m_by_time.erase({e.event_time, e.id});
+    auto user = m_by_user.find(e.user_id);
+    if (user != m_by_user.end()) {
+        user->second.erase({e.event_time, e.id});
+        if (user->second.empty()) {
+            m_by_user.erase(user);
+        }
+    }
+    if (e.recurrence.is_recurring()) {
+        m_recurring.erase({e.event_time, e.id});
+    } else {
+        m_columns.erase(id);
+        if (!e.reminder_sent) {
+            m_pending.erase({e.reminder_time, e.id});
+        }
+    }
+    m_by_id.erase(it);
+}
+
+std::vector<EventPtr> EventStore::collect_locked(const std::vector<uint32_t>& rows, bool by_reminder,
+                                                 const std::set<TimeKey>& extra) const {
+    std::vector<EventPtr> events;
+    events.reserve(rows.size() + extra.size());
+    for (uint32_t row : rows) {
+        events.push_back(m_by_id.at(m_columns.id(row)));
+    }
+    for (const auto& key : extra) {
+        events.push_back(m_by_id.at(key.second));
+    }
+
+    // Row order is arbitrary; the matches are few compared to the scan
+    auto key = [by_reminder](const EventPtr& event) {
+        return std::make_pair(by_reminder ? event->reminder_time : event->event_time, event->id);
+    };
+    std::sort(events.begin(), events.end(), [&](const EventPtr& a, const EventPtr& b) {
+        return key(a) < key(b);
+    });
+    return events;
+}
@@ -0,0 +1,87 @@
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Event.h"
+#include "EventColumns.h"
+
+// Events are immutable once published; a change replaces the whole object,
+// so readers and broadcasts can hold on to one without copying or locking
+using EventPtr = std::shared_ptr<const Event>;
+
+// Authoritative in-memory copy of the events table. Database loads it at
+// startup and publishes every committed write to it in commit order, so
+// listings, ownership checks and reminder scans never touch SQLite.
+//   by id:        hash map
+//   by time:      ordered (event_time, id)
+//   by user:      ordered (event_time, id) per user_id
+//   columns:      numeric fields as arrays (EventColumns) for range and
+//                 reminder scans, which run as flat loops instead of walking
+//                 a tree or touching every Event
+//   recurring:    ordered (event_time, id) of events with a repeat rule;
+//                 they stay out of the columns, whose scans match a single
+//                 event_time / reminder_time per row
+//   pending:      ordered (reminder_time, id) of single events whose
+//                 reminder hasn't been sent, so a reminder wakeup reads
+//                 only the due entries
+class EventStore {
+public:
+    EventStore();
+
+    // Drops everything; `expected` pre-sizes the id index for a load
+    void clear(size_t expected = 0);
+
+    // Write-through updates (also used to load); a null event erases `id`
+    void publish(const std::vector<std::pair<int, EventPtr>>& changes);
+
+    EventPtr find(int id) const;
+    std::vector<EventPtr> all() const;
+    std::vector<EventPtr> for_user(int user_id) const;
+    // Unsent single reminders plus every recurring event, by reminder_time
+    std::vector<EventPtr> pending_reminders() const;
+
+    // Single events whose reminder is due at `now` (the event itself hasn't
+    // started), by reminder_time. Reads the pending index from its start
+    // and stops at the first entry after `now`. Pending entries on the way
+    // whose event has already started are appended to `stale` by id; the
+    // two together are at most `limit`.
+    std::vector<EventPtr> due_reminders(std::chrono::system_clock::time_point now, size_t limit,
+                                        std::vector<int>& stale) const;
+
+    // Scans over the columns, so single events only; results are ordered
+    // like the index they replace
+    std::vector<EventPtr> between(std::chrono::system_clock::time_point from,
+                                  std::chrono::system_clock::time_point to) const;
+    size_t count_between(std::chrono::system_clock::time_point from,
+                         std::chrono::system_clock::time_point to) const;
+
+    // Recurring events whose first occurrence is before `to`, by event_time
+    std::vector<EventPtr> recurring_before(std::chrono::system_clock::time_point to) const;
+
+    size_t size() const;
+
+private:
+    using TimeKey = std::pair<std::chrono::system_clock::time_point, int>;
+
+    void insert_locked(EventPtr event);
+    void erase_locked(int id);
+    // Events of column `rows` and of `extra`, sorted by reminder or event time
+    std::vector<EventPtr> collect_locked(const std::vector<uint32_t>& rows, bool by_reminder,
+                                         const std::set<TimeKey>& extra) const;
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<int, EventPtr> m_by_id;
+    std::set<TimeKey> m_by_time;
+    std::unordered_map<int, std::set<TimeKey>> m_by_user;
+    EventColumns m_columns;
+    std::set<TimeKey> m_recurring;
+    std::set<TimeKey> m_pending;
+};
+
+#endif // EVENT_STORE_H
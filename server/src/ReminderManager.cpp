@@ -1,30 +1,56 @@
 #include "ReminderManager.h"
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <chrono>
 
-ReminderManager::ReminderManager(Database* database) 
-    : m_database(database), m_running(false) {
+ReminderManager::ReminderManager(Database* database, const Clock& clock)
+    : m_database(database), m_clock(clock), m_running(false), m_loaded(false) {
 }
 
 ReminderManager::~ReminderManager() {
     stop();
 }
 
+void ReminderManager::load() {
+    if (m_loaded) return;
+    m_loaded = true;
+    
+    // Listen first: a change committed while loading is applied on top
+    m_database->set_change_listener([this](const std::vector<std::pair<int, EventPtr>>& changes) {
+        onEventsChanged(changes);
+    });
+    
+    auto events = m_database->get_events_needing_reminder();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& event : events) {
+        scheduleLocked(event);
+    }
+}
+
 void ReminderManager::start() {
     if (m_running) return;
     
+    load();
     m_running = true;
     m_thread = std::thread([this]() {
         reminderLoop();
     });
     
-    std::cout << "Reminder manager started" << std::endl;
+    std::cout << "Reminder manager started (" << scheduledCount() << " reminders scheduled)" << std::endl;
 }
 
 void ReminderManager::stop() {
+    if (m_loaded) {
+        m_database->set_change_listener(nullptr);
+        m_loaded = false;
+    }
     if (m_running) {
-        m_running = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_wakeup.notify_all();
         if (m_thread.joinable()) {
             m_thread.join();
         }
@@ -32,53 +58,201 @@ void ReminderManager::stop() {
     }
 }
 
+size_t ReminderManager::scheduledCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_due.size();
+}
+
 void ReminderManager::reminderLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
     while (m_running) {
-        checkAndSendReminders();
-        std::this_thread::sleep_for(std::chrono::minutes(1)); // Check every minute
+        dropStaleLocked();
+        if (m_queue.empty()) {
+            m_wakeup.wait(lock);
+            continue;
+        }
+        
+        TimePoint due = m_queue.top().due;
+        if (m_clock.now() < due) {
+            // Woken early by stop() or by a change that needs an earlier wakeup
+            m_wakeup.wait_until(lock, due);
+            continue;
+        }
+        
+        auto now = m_clock.now();
+        std::vector<std::pair<int, TimePoint>> occurrences;
+        popDueLocked(now, occurrences);
+        
+        lock.unlock();
+        sendDueReminders(now, occurrences);
+        lock.lock();
     }
 }
 
-// void ReminderManager::checkAndSendReminders() {
-//     auto events = m_database->get_events_needing_reminder();
+Clock::time_point ReminderManager::nextDue() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    dropStaleLocked();
+    return m_queue.empty() ? TimePoint::max() : m_queue.top().due;
+}
+
+size_t ReminderManager::runDue() {
+    auto now = m_clock.now();
+    std::vector<std::pair<int, TimePoint>> occurrences;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        popDueLocked(now, occurrences);
+    }
+    return sendDueReminders(now, occurrences);
+}
+
+// The heap only says when to wake; the due-window query decides what to
+// send, so anything that slipped past the schedule goes out too. Recurring
+// entries are handed back since they are claimed per occurrence.
+void ReminderManager::popDueLocked(TimePoint now, std::vector<std::pair<int, TimePoint>>& occurrences) {
+    while (!m_queue.empty() && m_queue.top().due <= now) {
+        Entry entry = m_queue.top();
+        m_queue.pop();
+        auto it = m_due.find(entry.event_id);
+        if (it != m_due.end() && it->second == entry.due) {
+            m_due.erase(it);
+            auto occurrence = m_occurrence.find(entry.event_id);
+            if (occurrence != m_occurrence.end()) {
+                occurrences.emplace_back(entry.event_id, occurrence->second);
+                m_occurrence.erase(occurrence);
+            }
+        }
+    }
+}
+
+void ReminderManager::onEventsChanged(const std::vector<std::pair<int, EventPtr>>& changes) {
+    bool earlier = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        TimePoint next = m_queue.empty() ? TimePoint::max() : m_queue.top().due;
+        for (const auto& change : changes) {
+            m_due.erase(change.first);
+            m_occurrence.erase(change.first);
+            if (change.second && scheduleLocked(*change.second)) {
+                earlier = earlier || m_due[change.first] < next;
+            }
+        }
+        
+        // Superseded entries stay in the heap until they surface; rebuild
+        // once they outnumber the live ones
+        if (m_queue.size() > 2 * m_due.size() + 1024) {
+            std::vector<Entry> live;
+            live.reserve(m_due.size());
+            for (const auto& due : m_due) {
+                live.push_back({due.second, due.first});
+            }
+            m_queue = decltype(m_queue)(std::greater<Entry>(), std::move(live));
+        }
+    }
+    if (earlier) {
+        m_wakeup.notify_one();
+    }
+}
+
+bool ReminderManager::scheduleLocked(const Event& event) {
+    auto now = m_clock.now();
     
-//     for (auto& event : events) {
-//         if (event.needs_reminder()) {
-//             // Send reminder through callback
-//             if (m_reminderCallback) {
-//                 m_reminderCallback(event);
-//             }
-            
-//             // Mark reminder as sent
-//             event.reminder_sent = true;
-//             m_database->update_event(event);
-            
-//             std::cout << "Reminder sent for event: " << event.title << std::endl;
-//         }
-//     }
-// }
-
-void ReminderManager::checkAndSendReminders() {
-    // Get ALL events that need reminders (not user-specific)
-    auto events = m_database->get_events_needing_reminder();
+    if (event.recurrence.is_recurring()) {
+        TimePoint start;
+        TimePoint after = std::max(event.recurrence.last_reminded, now);
+        if (!event.recurrence.next_occurrence(event.event_time, after, start)) {
+            return false;   // series has ended
+        }
+        TimePoint due = start - (event.event_time - event.reminder_time);
+        m_due[event.id] = due;
+        m_occurrence[event.id] = start;
+        m_queue.push({due, event.id});
+        return true;
+    }
     
-    for (auto& event : events) {
-        if (event.needs_reminder()) {
-            // Send reminder to ALL users through callback
-            if (m_reminderCallback) {
-                m_reminderCallback(event);
+    // Once the event has started the reminder is moot (Event::needs_reminder)
+    if (event.reminder_sent || event.event_time <= now) {
+        return false;
+    }
+    m_due[event.id] = event.reminder_time;
+    m_queue.push({event.reminder_time, event.id});
+    return true;
+}
+
+void ReminderManager::dropStaleLocked() {
+    while (!m_queue.empty()) {
+        auto it = m_due.find(m_queue.top().event_id);
+        if (it != m_due.end() && it->second == m_queue.top().due) {
+            return;
+        }
+        m_queue.pop();
+    }
+}
+
+size_t ReminderManager::sendDueReminders(TimePoint now, const std::vector<std::pair<int, TimePoint>>& occurrences) {
+    const size_t kMaxPerTick = 1000;
+    size_t sent = 0;
+    
+    // Occurrences ride along with the first window of single reminders
+    auto recurring = claimOccurrences(occurrences);
+    
+    std::vector<int> stale;
+    for (;;) {
+        auto due = m_database->get_due_reminders(now, kMaxPerTick, stale);
+        if (due.empty() && stale.empty()) {
+            if (!recurring.empty() && m_reminderCallback) {
+                m_reminderCallback(recurring);
             }
-            
-            // Mark reminder as sent
-            event.reminder_sent = true;
-            m_database->update_event(event);
-            
-            std::cout << "Reminder sent to all users for event: " << event.title 
-                      << " (Created by User ID: " << event.user_id << ")" << std::endl;
+            return sent + recurring.size();
+        }
+        
+        std::vector<int> event_ids;
+        event_ids.reserve(due.size() + stale.size());
+        for (const auto& event : due) {
+            event_ids.push_back(event.id);
+        }
+        // Reminders whose event started without them are marked in the same
+        // write, which takes them out of the pending index for good; they
+        // are not sent
+        event_ids.insert(event_ids.end(), stale.begin(), stale.end());
+        
+        // Claim first, in one transaction: only rows this call flipped are
+        // sent, so a reminder never goes out twice
+        auto marked = m_database->mark_reminders_sent(event_ids);
+        size_t claimed = marked.size();
+        marked.erase(std::remove_if(marked.begin(), marked.end(),
+                                    [&](const EventPtr& event) { return event->event_time <= now; }),
+                     marked.end());
+        marked.insert(marked.end(), recurring.begin(), recurring.end());
+        recurring.clear();
+        if (!marked.empty() && m_reminderCallback) {
+            m_reminderCallback(marked);
         }
+        sent += marked.size();
+        
+        if (claimed == 0 || event_ids.size() < kMaxPerTick) {
+            return sent;
+        }
+    }
+}
+
+// Returns one event per claimed occurrence, its times moved to that
+// occurrence, so the callback can treat it like a single reminder
+std::vector<EventPtr> ReminderManager::claimOccurrences(const std::vector<std::pair<int, TimePoint>>& occurrences) {
+    std::vector<EventPtr> reminders;
+    if (occurrences.empty()) {
+        return reminders;
+    }
+    
+    std::unordered_map<int, TimePoint> starts(occurrences.begin(), occurrences.end());
+    for (const auto& claimed : m_database->claim_occurrence_reminders(occurrences)) {
+        auto occurrence = std::make_shared<Event>(*claimed);
+        occurrence->event_time = starts[claimed->id];
+        occurrence->reminder_time = occurrence->event_time - (claimed->event_time - claimed->reminder_time);
+        reminders.push_back(std::move(occurrence));
     }
+    return reminders;
 }
 
-void ReminderManager::setReminderCallback(std::function<void(const Event&)> callback) {
+void ReminderManager::setReminderCallback(std::function<void(const std::vector<EventPtr>& events)> callback) {
     m_reminderCallback = callback;
 }
\ No newline at end of file
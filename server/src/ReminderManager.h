@@ -4,27 +4,92 @@
 #include <thread>
 #include <functional>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include "Clock.h"
 #include "Database.h"
 #include "Event.h"
 
+// Schedules reminders by reminder_time instead of polling. Unsent reminders
+// are loaded once at start(); after that every committed create / update /
+// delete reaches the schedule through Database's change listener. The
+// thread sleeps until the earliest due time (or a change that moves it
+// earlier), then sends what the database's due-window query returns,
+// marking the whole tick sent in one write.
+//
+// A recurring event is scheduled one occurrence at a time: the next one
+// that has not started and is later than the rule's last_reminded. Its
+// reminder is claimed by advancing last_reminded, and the resulting change
+// schedules the occurrence after it.
+//
+// All times come from the injected Clock. start() runs the thread, which
+// sleeps on the wall clock, so it is for Clock::system(); a simulation on a
+// VirtualClock calls load() and then drives the schedule itself by moving
+// the clock to nextDue() and calling runDue().
 class ReminderManager {
 public:
-    explicit ReminderManager(Database* database);
+    // `clock` must outlive the manager
+    explicit ReminderManager(Database* database, const Clock& clock = Clock::system());
     ~ReminderManager();
     
+    // Subscribes to changes and loads the unsent reminders (start() does
+    // this if it hasn't been done)
+    void load();
     void start();
     void stop();
     
-    void setReminderCallback(std::function<void(const Event&)> callback);
+    // Earliest scheduled due time; time_point::max() when nothing is
+    // scheduled
+    Clock::time_point nextDue();
+    
+    // Sends everything due at the clock's current time, as one reminder
+    // thread wakeup would. Returns the number of reminders delivered.
+    size_t runDue();
+    
+    // Called once per due window with every reminder it claimed
+    void setReminderCallback(std::function<void(const std::vector<EventPtr>& events)> callback);
+    
+    // Number of events currently waiting for their reminder
+    size_t scheduledCount() const;
     
 private:
+    using TimePoint = std::chrono::system_clock::time_point;
+    
+    // Min-heap entry; stale once m_due no longer holds this time for the id
+    struct Entry {
+        TimePoint due;
+        int event_id;
+        bool operator>(const Entry& other) const {
+            return due != other.due ? due > other.due : event_id > other.event_id;
+        }
+    };
+    
     void reminderLoop();
-    void checkAndSendReminders();
+    void onEventsChanged(const std::vector<std::pair<int, EventPtr>>& changes);
+    size_t sendDueReminders(TimePoint now, const std::vector<std::pair<int, TimePoint>>& occurrences);
+    std::vector<EventPtr> claimOccurrences(const std::vector<std::pair<int, TimePoint>>& occurrences);
+    
+    // Callers hold m_mutex
+    bool scheduleLocked(const Event& event);
+    void dropStaleLocked();
+    void popDueLocked(TimePoint now, std::vector<std::pair<int, TimePoint>>& occurrences);
     
     Database* m_database;
+    const Clock& m_clock;
     std::thread m_thread;
     std::atomic<bool> m_running;
-    std::function<void(const Event&)> m_reminderCallback;
+    bool m_loaded;
+    std::function<void(const std::vector<EventPtr>& events)> m_reminderCallback;
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_queue;
+    std::unordered_map<int, TimePoint> m_due;
+    std::unordered_map<int, TimePoint> m_occurrence;   // recurring ids: start of the scheduled occurrence
 };
 
-#endif // REMINDER_MANAGER_H
\ No newline at end of file
+#endif // REMINDER_MANAGER_H
@@ -0,0 +1,117 @@
+#ifndef ROW_CODEC_H
+#define ROW_CODEC_H
+
+#include <sqlite3.h>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "Recurrence.h"
+#include "Schema.h"
+
+// SQLite side of the Schema tables: bind() sets every stored member of an
+// object as a statement parameter, read() fills one back in from a SELECT *
+// (or RETURNING *) row. The member in column N is always parameter ?N+1,
+// so statements name the parameters they use by number and leave the rest
+// unused:
+//
+//   UPDATE events SET title = ?3 ... WHERE id = ?1
+//
+// Extra parameters (an owner check, say) are numbered after the last column.
+namespace RowCodec {
+
+inline void bind_value(sqlite3_stmt* stmt, int index, int value) {
+    sqlite3_bind_int(stmt, index, value);
+}
+
+inline void bind_value(sqlite3_stmt* stmt, int index, bool value) {
+    sqlite3_bind_int(stmt, index, value ? 1 : 0);
+}
+
+// The object must outlive the statement's step
+inline void bind_value(sqlite3_stmt* stmt, int index, const std::string& value) {
+    sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+}
+
+inline void bind_value(sqlite3_stmt* stmt, int index, Schema::TimePoint value) {
+    sqlite3_bind_int64(stmt, index, Schema::Codec<Schema::TimePoint>::ms(value));
+}
+
+// NULL for single events; the rule's text is a temporary, so SQLite copies it
+inline void bind_value(sqlite3_stmt* stmt, int index, const Recurrence& value) {
+    if (!value.is_recurring()) {
+        sqlite3_bind_null(stmt, index);
+        return;
+    }
+    std::string text = value.to_json().dump();
+    sqlite3_bind_text(stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+}
+
+inline bool read_value(sqlite3_stmt* stmt, int column, int& value) {
+    value = sqlite3_column_int(stmt, column);
+    return true;
+}
+
+inline bool read_value(sqlite3_stmt* stmt, int column, bool& value) {
+    value = sqlite3_column_int(stmt, column) == 1;
+    return true;
+}
+
+// Assigned in place with the column's byte length, so a reused object keeps
+// its buffers and nothing calls strlen. NULL (description and creator are
+// nullable, for rows written by other tools) reads as empty.
+inline bool read_value(sqlite3_stmt* stmt, int column, std::string& value) {
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    if (text) {
+        value.assign(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, column));
+    } else {
+        value.clear();
+    }
+    return true;
+}
+
+inline bool read_value(sqlite3_stmt* stmt, int column, Schema::TimePoint& value) {
+    value = Schema::Codec<Schema::TimePoint>::from_ms(sqlite3_column_int64(stmt, column));
+    return true;
+}
+
+// Written by bind_value, so a parse failure means the row was edited by
+// hand; false, with the event left a single one
+inline bool read_value(sqlite3_stmt* stmt, int column, Recurrence& value) {
+    value = Recurrence();
+    if (sqlite3_column_type(stmt, column) != SQLITE_TEXT) {
+        return true;
+    }
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    auto rule = nlohmann::json::parse(text, text + sqlite3_column_bytes(stmt, column), nullptr, false);
+    std::string error;
+    if (rule.is_discarded() || !Recurrence::from_json(rule, value, error)) {
+        value = Recurrence();
+        return false;
+    }
+    return true;
+}
+
+template <class T>
+void bind(sqlite3_stmt* stmt, const T& object) {
+    Schema::for_each_field<T>([&](const auto& field) {
+        if (field.column >= 0) {
+            bind_value(stmt, field.column + 1, object.*field.member);
+        }
+    });
+}
+
+// False if some column held a value that couldn't be read (the member is
+// then left at its default)
+template <class T>
+bool read(sqlite3_stmt* stmt, T& object) {
+    bool ok = true;
+    Schema::for_each_field<T>([&](const auto& field) {
+        if (field.column >= 0 && !read_value(stmt, field.column, object.*field.member)) {
+            ok = false;
+        }
+    });
+    return ok;
+}
+
+} // namespace RowCodec
+
+#endif // ROW_CODEC_H
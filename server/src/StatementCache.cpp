@@ -0,0 +1,80 @@
+#include "StatementCache.h"
+#include <iostream>
+
+StatementCache::Handle::Handle(sqlite3_stmt* stmt, uint64_t* executions, uint64_t* total_ns)
+    : m_stmt(stmt), m_executions(executions), m_total_ns(total_ns),
+      m_start(std::chrono::steady_clock::now()) {
+}
+
+StatementCache::Handle::Handle(Handle&& other) noexcept
+    : m_stmt(other.m_stmt), m_executions(other.m_executions), m_total_ns(other.m_total_ns),
+      m_start(other.m_start) {
+    other.m_stmt = nullptr;
+}
+
+StatementCache::Handle::~Handle() {
+    if (!m_stmt) return;
+
+    // Release read locks / text buffers and make the statement ready for reuse
+    sqlite3_reset(m_stmt);
+    sqlite3_clear_bindings(m_stmt);
+
+    *m_executions += 1;
+    *m_total_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start).count());
+}
+
+StatementCache::~StatementCache() {
+    finalize_all();
+}
+
+bool StatementCache::prepare(sqlite3* db, size_t index, const std::string& name, const std::string& sql) {
+    if (index >= m_entries.size()) {
+        m_entries.resize(index + 1);
+    }
+
+    Entry& entry = m_entries[index];
+    if (entry.stmt) {
+        sqlite3_finalize(entry.stmt);
+        entry.stmt = nullptr;
+    }
+
+    // Persistent: the statement lives for the whole connection
+    int rc = sqlite3_prepare_v3(db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &entry.stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement " << name << ": " << sqlite3_errmsg(db) << std::endl;
+        entry.stmt = nullptr;
+        return false;
+    }
+
+    entry.name = name;
+    entry.executions = 0;
+    entry.total_ns = 0;
+    return true;
+}
+
+StatementCache::Handle StatementCache::acquire(size_t index) {
+    if (index >= m_entries.size() || !m_entries[index].stmt) {
+        return Handle(nullptr, nullptr, nullptr);
+    }
+    Entry& entry = m_entries[index];
+    return Handle(entry.stmt, &entry.executions, &entry.total_ns);
+}
+
+std::vector<StatementStats> StatementCache::stats() const {
+    std::vector<StatementStats> result;
+    for (const auto& entry : m_entries) {
+        if (!entry.stmt) continue;
+        result.push_back({entry.name, entry.executions, entry.total_ns / 1e6});
+    }
+    return result;
+}
+
+void StatementCache::finalize_all() {
+    for (auto& entry : m_entries) {
+        if (entry.stmt) {
+            sqlite3_finalize(entry.stmt);
+            entry.stmt = nullptr;
+        }
+    }
+}
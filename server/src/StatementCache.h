@@ -0,0 +1,64 @@
+#ifndef STATEMENT_CACHE_H
+#define STATEMENT_CACHE_H
+
+#include <sqlite3.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Execution counters for one cached statement
+struct StatementStats {
+    std::string name;
+    uint64_t executions;
+    double total_ms;
+};
+
+// Statements prepared once per connection and reused with sqlite3_reset /
+// sqlite3_clear_bindings, so SQL is parsed and planned only at startup.
+class StatementCache {
+public:
+    // Borrowed statement: resets itself and records timing when it goes out of scope
+    class Handle {
+    public:
+        Handle(sqlite3_stmt* stmt, uint64_t* executions, uint64_t* total_ns);
+        Handle(Handle&& other) noexcept;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle();
+
+        sqlite3_stmt* get() const { return m_stmt; }
+        operator sqlite3_stmt*() const { return m_stmt; }
+        explicit operator bool() const { return m_stmt != nullptr; }
+
+    private:
+        sqlite3_stmt* m_stmt;
+        uint64_t* m_executions;
+        uint64_t* m_total_ns;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    StatementCache() = default;
+    ~StatementCache();
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // Prepares sql into slot `index`; returns false (and logs) on error
+    bool prepare(sqlite3* db, size_t index, const std::string& name, const std::string& sql);
+    Handle acquire(size_t index);
+
+    std::vector<StatementStats> stats() const;
+    void finalize_all();
+
+private:
+    struct Entry {
+        sqlite3_stmt* stmt = nullptr;
+        std::string name;
+        uint64_t executions = 0;
+        uint64_t total_ns = 0;
+    };
+
+    std::vector<Entry> m_entries;
+};
+
+#endif // STATEMENT_CACHE_H
@@ -0,0 +1,193 @@
+#include "TokenSigner.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <cstring>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+
+namespace {
+const std::string kTokenPrefix = "v1.";
+const size_t kSha256BlockSize = 64;
+
+// Per-thread scratch context reused for every digest
+EVP_MD_CTX* scratch_context() {
+    struct Holder {
+        EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+        ~Holder() { EVP_MD_CTX_free(ctx); }
+    };
+    thread_local Holder holder;
+    return holder.ctx;
+}
+
+std::string to_hex(const unsigned char* data, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(length * 2, '0');
+    for (size_t i = 0; i < length; ++i) {
+        out[i * 2] = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0x0f];
+    }
+    return out;
+}
+
+// Non-negative decimal; false on anything else, overflow included, since
+// the text is unauthenticated until the signature has been checked
+bool parse_int64(const std::string& text, int64_t& value) {
+    if (text.empty() || text.size() > 19) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        int digit = c - '0';
+        if (value > (INT64_MAX - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+// Latest expiry a system_clock time_point can hold; its ticks are finer
+// than milliseconds, so larger values would overflow the conversion
+int64_t max_expires_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::time_point::max().time_since_epoch()).count();
+}
+} // namespace
+
+TokenSigner::KeyState::~KeyState() {
+    EVP_MD_CTX_free(inner);
+    EVP_MD_CTX_free(outer);
+}
+
+void TokenSigner::add_key(const std::string& key_id, const std::string& secret) {
+    if (key_id.empty() || secret.empty() || key_id.find('.') != std::string::npos) {
+        return;
+    }
+    
+    // Standard HMAC key schedule (RFC 2104): long keys are hashed first
+    unsigned char key_block[kSha256BlockSize] = {0};
+    if (secret.size() > kSha256BlockSize) {
+        unsigned int length = 0;
+        EVP_Digest(secret.data(), secret.size(), key_block, &length, EVP_sha256(), nullptr);
+    } else {
+        std::memcpy(key_block, secret.data(), secret.size());
+    }
+    
+    unsigned char ipad[kSha256BlockSize];
+    unsigned char opad[kSha256BlockSize];
+    for (size_t i = 0; i < kSha256BlockSize; ++i) {
+        ipad[i] = key_block[i] ^ 0x36;
+        opad[i] = key_block[i] ^ 0x5c;
+    }
+    
+    auto state = std::make_shared<KeyState>();
+    state->inner = EVP_MD_CTX_new();
+    state->outer = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(state->inner, EVP_sha256(), nullptr);
+    EVP_DigestUpdate(state->inner, ipad, sizeof(ipad));
+    EVP_DigestInit_ex(state->outer, EVP_sha256(), nullptr);
+    EVP_DigestUpdate(state->outer, opad, sizeof(opad));
+    
+    m_keys[key_id] = state;
+    if (m_signing_key_id.empty()) {
+        m_signing_key_id = key_id;
+    }
+}
+
+size_t TokenSigner::load_keys(const std::string& spec) {
+    size_t added = 0;
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+        size_t colon = entry.find(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 >= entry.size()) {
+            continue;
+        }
+        size_t before = m_keys.size();
+        add_key(entry.substr(0, colon), entry.substr(colon + 1));
+        if (m_keys.size() > before) ++added;
+    }
+    return added;
+}
+
+std::string TokenSigner::sign(int user_id, std::chrono::system_clock::time_point expires_at) const {
+    auto secret = m_keys.find(m_signing_key_id);
+    if (secret == m_keys.end()) {
+        return "";
+    }
+
+    unsigned char nonce[8];
+    RAND_bytes(nonce, sizeof(nonce));
+
+    auto expires_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        expires_at.time_since_epoch()).count();
+
+    std::string payload = kTokenPrefix + std::to_string(user_id) + "." +
+                          std::to_string(expires_ms) + "." + m_signing_key_id + "." +
+                          to_hex(nonce, sizeof(nonce));
+    return payload + "." + hmac_hex(*secret->second, payload);
+}
+
+bool TokenSigner::verify(const std::string& token, Claims& claims) const {
+    if (!looks_signed(token)) return false;
+
+    // v1 . user_id . expires_ms . key_id . nonce . signature
+    std::string parts[6];
+    size_t count = 0;
+    size_t start = 0;
+    while (count < 6) {
+        size_t dot = token.find('.', start);
+        size_t end = (dot == std::string::npos) ? token.size() : dot;
+        parts[count++].assign(token, start, end - start);
+        if (dot == std::string::npos) break;
+        start = dot + 1;
+    }
+    if (count != 6 || start + parts[5].size() != token.size()) {
+        return false;
+    }
+
+    int64_t user_id = 0;
+    int64_t expires_ms = 0;
+    if (!parse_int64(parts[1], user_id) || !parse_int64(parts[2], expires_ms) ||
+        user_id <= 0 || user_id > INT32_MAX || expires_ms > max_expires_ms()) {
+        return false;
+    }
+
+    auto key = m_keys.find(parts[3]);
+    if (key == m_keys.end()) return false;
+
+    std::string payload = token.substr(0, token.size() - parts[5].size() - 1);
+    std::string expected = hmac_hex(*key->second, payload);
+    if (expected.size() != parts[5].size() ||
+        CRYPTO_memcmp(expected.data(), parts[5].data(), expected.size()) != 0) {
+        return false;
+    }
+
+    claims.user_id = static_cast<int>(user_id);
+    claims.expires_at = std::chrono::system_clock::time_point(std::chrono::milliseconds(expires_ms));
+    claims.key_id = parts[3];
+    claims.signature = parts[5];
+    return true;
+}
+
+bool TokenSigner::looks_signed(const std::string& token) {
+    return token.compare(0, kTokenPrefix.size(), kTokenPrefix) == 0;
+}
+
+std::string TokenSigner::hmac_hex(const KeyState& key, const std::string& message) const {
+    EVP_MD_CTX* ctx = scratch_context();
+    unsigned char inner_digest[EVP_MAX_MD_SIZE];
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int inner_length = 0;
+    unsigned int digest_length = 0;
+    
+    // H((K ^ opad) || H((K ^ ipad) || message))
+    EVP_MD_CTX_copy_ex(ctx, key.inner);
+    EVP_DigestUpdate(ctx, message.data(), message.size());
+    EVP_DigestFinal_ex(ctx, inner_digest, &inner_length);
+    
+    EVP_MD_CTX_copy_ex(ctx, key.outer);
+    EVP_DigestUpdate(ctx, inner_digest, inner_length);
+    EVP_DigestFinal_ex(ctx, digest, &digest_length);
+    
+    return to_hex(digest, digest_length);
+}
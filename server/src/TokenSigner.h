@@ -0,0 +1,54 @@
+#ifndef TOKEN_SIGNER_H
+#define TOKEN_SIGNER_H
+
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+
+typedef struct evp_md_ctx_st EVP_MD_CTX;
+
+// Stateless session tokens: "v1.<user_id>.<expires_ms>.<key_id>.<nonce>.<hmac>"
+// where hmac is HMAC-SHA256 over everything before the last dot. Any process
+// holding the key can validate a token without a lookup, and tokens survive
+// server restarts.
+class TokenSigner {
+public:
+    struct Claims {
+        int user_id = 0;
+        std::chrono::system_clock::time_point expires_at;
+        std::string key_id;
+        std::string signature;
+    };
+
+    // The first key added becomes the signing key; later keys only verify
+    // (used while rotating secrets)
+    void add_key(const std::string& key_id, const std::string& secret);
+    bool enabled() const { return !m_signing_key_id.empty(); }
+
+    // Parses "kid:secret[,kid:secret...]"; returns number of keys added
+    size_t load_keys(const std::string& spec);
+
+    std::string sign(int user_id, std::chrono::system_clock::time_point expires_at) const;
+
+    // Checks format and signature only; expiry is left to the caller
+    bool verify(const std::string& token, Claims& claims) const;
+
+    static bool looks_signed(const std::string& token);
+
+private:
+    // HMAC-SHA256 with the ipad/opad blocks already absorbed, so each token
+    // costs two digest finalizations instead of a full HMAC setup
+    struct KeyState {
+        EVP_MD_CTX* inner = nullptr;
+        EVP_MD_CTX* outer = nullptr;
+        ~KeyState();
+    };
+
+    std::string hmac_hex(const KeyState& key, const std::string& message) const;
+
+    std::unordered_map<std::string, std::shared_ptr<KeyState>> m_keys;
+    std::string m_signing_key_id;
+};
+
+#endif // TOKEN_SIGNER_H
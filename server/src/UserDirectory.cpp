@@ -0,0 +1,138 @@
+#include "UserDirectory.h"
+#include <algorithm>
+
+namespace {
+const size_t kInitialFilterCapacity = 1024;
+const double kFilterFalsePositiveRate = 0.01;
+
+int64_t to_ms(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+} // namespace
+
+UserRecord UserRecord::from_user(const User& user) {
+    UserRecord record;
+    record.id = user.id;
+    record.username = user.username;
+    record.email = user.email;
+    record.password_hash = user.password_hash;
+    record.display_name = user.display_name;
+    record.created_at_ms = to_ms(user.created_at);
+    record.last_login_ms = to_ms(user.last_login);
+    record.is_active = user.is_active;
+    return record;
+}
+
+User UserRecord::to_user() const {
+    User user;
+    user.id = id;
+    user.username = username;
+    user.email = email;
+    user.password_hash = password_hash;
+    user.display_name = display_name;
+    user.created_at = std::chrono::system_clock::time_point(std::chrono::milliseconds(created_at_ms));
+    user.last_login = std::chrono::system_clock::time_point(std::chrono::milliseconds(last_login_ms));
+    user.is_active = is_active;
+    return user;
+}
+
+UserDirectory::UserDirectory()
+    : m_username_filter(kInitialFilterCapacity, kFilterFalsePositiveRate)
+    , m_email_filter(kInitialFilterCapacity, kFilterFalsePositiveRate) {
+}
+
+void UserDirectory::load(const std::vector<User>& users) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_by_id.clear();
+    m_username_index.clear();
+    m_email_index.clear();
+    rebuild_filters_locked(std::max(kInitialFilterCapacity, users.size() * 2));
+
+    for (const auto& user : users) {
+        add_locked(UserRecord::from_user(user));
+    }
+}
+
+void UserDirectory::add(const User& user) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    add_locked(UserRecord::from_user(user));
+}
+
+void UserDirectory::set_last_login(int user_id, std::chrono::system_clock::time_point when) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_by_id.find(user_id);
+    if (it != m_by_id.end()) {
+        it->second.last_login_ms = to_ms(when);
+    }
+}
+
+bool UserDirectory::find_by_id(int user_id, UserRecord& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_by_id.find(user_id);
+    if (it == m_by_id.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+bool UserDirectory::find_by_username(const std::string& username, UserRecord& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_username_filter.might_contain(username)) {
+        return false;
+    }
+    auto it = m_username_index.find(username);
+    if (it == m_username_index.end()) {
+        return false;
+    }
+    out = m_by_id.at(it->second);
+    return true;
+}
+
+bool UserDirectory::username_exists(const std::string& username) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_username_filter.might_contain(username) &&
+           m_username_index.count(username) > 0;
+}
+
+bool UserDirectory::email_exists(const std::string& email) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_email_filter.might_contain(email) &&
+           m_email_index.count(email) > 0;
+}
+
+size_t UserDirectory::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_by_id.size();
+}
+
+void UserDirectory::add_locked(UserRecord record) {
+    // Keep the false positive rate bounded as the user base grows
+    if (m_by_id.size() + 1 > m_username_filter.capacity()) {
+        rebuild_filters_locked(m_username_filter.capacity() * 2);
+    }
+
+    // A re-read row replaces the old one; the filters can keep stale names,
+    // which only costs a map lookup
+    auto existing = m_by_id.find(record.id);
+    if (existing != m_by_id.end()) {
+        m_username_index.erase(existing->second.username);
+        m_email_index.erase(existing->second.email);
+    }
+
+    m_username_filter.insert(record.username);
+    m_email_filter.insert(record.email);
+    m_username_index[record.username] = record.id;
+    m_email_index[record.email] = record.id;
+    int id = record.id;
+    m_by_id[id] = std::move(record);
+}
+
+void UserDirectory::rebuild_filters_locked(size_t expected_items) {
+    m_username_filter = BloomFilter(expected_items, kFilterFalsePositiveRate);
+    m_email_filter = BloomFilter(expected_items, kFilterFalsePositiveRate);
+    for (const auto& entry : m_by_id) {
+        m_username_filter.insert(entry.second.username);
+        m_email_filter.insert(entry.second.email);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef USER_DIRECTORY_H
+#define USER_DIRECTORY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include "BloomFilter.h"
+#include "User.h"
+
+// Compact in-memory copy of a users row
+struct UserRecord {
+    int id;
+    std::string username;
+    std::string email;
+    std::string password_hash;
+    std::string display_name;
+    int64_t created_at_ms;
+    int64_t last_login_ms;
+    bool is_active;
+
+    static UserRecord from_user(const User& user);
+    User to_user() const;
+};
+
+// Write-through cache of the users table. Loaded at startup and updated after
+// every successful insert, and by AuthManager with rows it re-reads (logins,
+// and users other servers registered). Bloom filters answer "definitely not
+// taken" without touching the maps.
+class UserDirectory {
+public:
+    UserDirectory();
+
+    void load(const std::vector<User>& users);
+
+    // Write-through updates (call after the database write succeeded); add()
+    // also replaces a user already present
+    void add(const User& user);
+    void set_last_login(int user_id, std::chrono::system_clock::time_point when);
+
+    // Lookups - return false when the user is unknown
+    bool find_by_id(int user_id, UserRecord& out) const;
+    bool find_by_username(const std::string& username, UserRecord& out) const;
+
+    bool username_exists(const std::string& username) const;
+    bool email_exists(const std::string& email) const;
+
+    size_t size() const;
+
+private:
+    void add_locked(UserRecord record);
+    void rebuild_filters_locked(size_t expected_items);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<int, UserRecord> m_by_id;
+    std::unordered_map<std::string, int> m_username_index;
+    std::unordered_map<std::string, int> m_email_index;
+    BloomFilter m_username_filter;
+    BloomFilter m_email_filter;
+};
+
+#endif // USER_DIRECTORY_H
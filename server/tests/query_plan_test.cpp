@@ -0,0 +1,105 @@
+// Every hot statement must be answered through its index, on a database
+// created by this build and on one created before migrations existed and
+// upgraded in place. Also checks that a missing index is reported, so the
+// check itself can't pass vacuously.
+//
+// Usage: query_plan_test [db_dir=.]
+
+#include "Database.h"
+#include <sqlite3.h>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void remove_database(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+bool execute(const std::string& path, const char* sql) {
+    sqlite3* db = nullptr;
+    bool ok = sqlite3_open(path.c_str(), &db) == SQLITE_OK &&
+              sqlite3_exec(db, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+    if (!ok) {
+        std::cerr << path << ": " << sqlite3_errmsg(db) << std::endl;
+    }
+    sqlite3_close(db);
+    return ok;
+}
+
+// Schema and rows as the server wrote them before PRAGMA user_version was used
+const char* kLegacyDatabase = R"(
+    CREATE TABLE users (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        username TEXT UNIQUE NOT NULL,
+        email TEXT UNIQUE NOT NULL,
+        password_hash TEXT NOT NULL,
+        display_name TEXT NOT NULL,
+        created_at INTEGER NOT NULL,
+        last_login INTEGER NOT NULL,
+        is_active INTEGER DEFAULT 1
+    );
+    CREATE TABLE events (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        user_id INTEGER NOT NULL,
+        title TEXT NOT NULL,
+        description TEXT,
+        event_time INTEGER NOT NULL,
+        reminder_time INTEGER NOT NULL,
+        creator TEXT,
+        reminder_sent INTEGER DEFAULT 0,
+        created_at INTEGER NOT NULL,
+        FOREIGN KEY (user_id) REFERENCES users (id)
+    );
+    INSERT INTO users (username, email, password_hash, display_name, created_at, last_login)
+        VALUES ('alice', 'alice@example.com', 'x', 'Alice', 0, 0),
+               ('bob', 'bob@example.com', 'x', 'Bob', 0, 0);
+    INSERT INTO events (user_id, title, description, event_time, reminder_time, creator, reminder_sent, created_at)
+        VALUES (1, 'Standup', '', 1800000000000, 1799999100000, 'alice', 0, 0),
+               (2, 'Review', '', 1700000000000, 1699999100000, 'bob', 1, 0);
+)";
+
+bool check(const char* name, bool passed) {
+    std::cout << (passed ? "PASS " : "FAIL ") << name << std::endl;
+    return passed;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string dir = argc > 1 ? argv[1] : ".";
+    bool passed = true;
+
+    std::string fresh_path = dir + "/query_plan_fresh.db";
+    remove_database(fresh_path);
+    int latest_version = 0;
+    {
+        Database database(fresh_path);
+        latest_version = database.schema_version();
+        passed &= check("fresh database opens", latest_version > 0);
+        passed &= check("fresh database uses its indexes", database.verify_query_plans());
+    }
+    remove_database(fresh_path);
+
+    std::string legacy_path = dir + "/query_plan_legacy.db";
+    remove_database(legacy_path);
+    passed &= check("legacy database created", execute(legacy_path, kLegacyDatabase));
+    {
+        Database database(legacy_path);
+        passed &= check("legacy database migrates", database.schema_version() == latest_version);
+        passed &= check("migrated database uses its indexes", database.verify_query_plans());
+    }
+
+    // Migrations don't run again at the latest version, so the index stays gone
+    passed &= check("index dropped", execute(legacy_path, "DROP INDEX idx_events_user_time;"));
+    {
+        Database database(legacy_path);
+        passed &= check("missing index is reported", !database.verify_query_plans());
+    }
+    remove_database(legacy_path);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// Occurrences of repeat rules where the calendar math or the jump to a
+// far window could go wrong: monthly rules on days short months lack,
+// count combined with exceptions, windows years after the first
+// occurrence (checked against a plain walk of the series), and the end of
+// a series.
+//
+// Usage: recurrence_test
+
+#include "Recurrence.h"
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using TimePoint = Recurrence::TimePoint;
+
+TimePoint utc(int year, int month, int day, int hour = 10) {
+    std::tm tm{};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    return std::chrono::system_clock::from_time_t(timegm(&tm));
+}
+
+Recurrence rule(Recurrence::Frequency frequency, int interval = 1, int count = 0) {
+    Recurrence recurrence;
+    recurrence.frequency = frequency;
+    recurrence.interval = interval;
+    recurrence.count = count;
+    return recurrence;
+}
+
+// Every occurrence of a daily / weekly rule in [from, to), found by
+// stepping from the first one
+std::vector<TimePoint> walk(const Recurrence& recurrence, TimePoint first, TimePoint from, TimePoint to) {
+    std::vector<TimePoint> starts;
+    auto step = std::chrono::hours(24 * (recurrence.frequency == Recurrence::Weekly ? 7 : 1) * recurrence.interval);
+    TimePoint start = first;
+    for (int n = 0; recurrence.count == 0 || n < recurrence.count; ++n, start += step) {
+        if (recurrence.until != TimePoint() && start > recurrence.until) break;
+        if (start >= to) break;
+        if (start >= from &&
+            !std::binary_search(recurrence.exceptions.begin(), recurrence.exceptions.end(), start)) {
+            starts.push_back(start);
+        }
+    }
+    return starts;
+}
+
+bool check(const char* name, bool passed) {
+    std::cout << (passed ? "PASS " : "FAIL ") << name << std::endl;
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    bool passed = true;
+
+    // 2024 is a leap year: February has 29 days, still not 30 or 31
+    Recurrence monthly = rule(Recurrence::Monthly);
+    TimePoint jan31 = utc(2024, 1, 31);
+    passed &= check("monthly on the 31st skips short months",
+                    monthly.occurrences_between(jan31, utc(2024, 1, 1), utc(2025, 1, 1)) ==
+                    std::vector<TimePoint>{jan31, utc(2024, 3, 31), utc(2024, 5, 31), utc(2024, 7, 31),
+                                           utc(2024, 8, 31), utc(2024, 10, 31), utc(2024, 12, 31)});
+    passed &= check("monthly on the 31st, window far from the start",
+                    monthly.occurrences_between(jan31, utc(2031, 2, 1), utc(2031, 6, 1)) ==
+                    std::vector<TimePoint>{utc(2031, 3, 31), utc(2031, 5, 31)});
+
+    TimePoint jan29 = utc(2023, 1, 29);
+    passed &= check("monthly on the 29th skips February but not a leap February",
+                    monthly.occurrences_between(jan29, utc(2023, 2, 1), utc(2024, 4, 1)).size() == 13 &&
+                    monthly.occurrences_between(jan29, utc(2023, 2, 1), utc(2023, 3, 1)).empty() &&
+                    monthly.occurrences_between(jan29, utc(2024, 2, 1), utc(2024, 3, 1)) ==
+                    std::vector<TimePoint>{utc(2024, 2, 29)});
+
+    // Skipped months aren't occurrences, so they don't use up the count
+    Recurrence monthly_count = rule(Recurrence::Monthly, 1, 3);
+    passed &= check("monthly count counts only months that have the day",
+                    monthly_count.occurrences_between(jan31, utc(2024, 1, 1), utc(2026, 1, 1)) ==
+                    std::vector<TimePoint>{jan31, utc(2024, 3, 31), utc(2024, 5, 31)} &&
+                    monthly_count.occurrences_between(jan31, utc(2024, 5, 1), utc(2026, 1, 1)) ==
+                    std::vector<TimePoint>{utc(2024, 5, 31)});
+
+    // count is applied before exceptions, as RRULE COUNT / EXDATE
+    Recurrence weekly = rule(Recurrence::Weekly, 1, 5);
+    TimePoint first = utc(2024, 3, 4);
+    auto week = [&](int n) { return first + std::chrono::hours(24 * 7 * n); };
+    weekly.exceptions = {week(1), week(3)};
+    passed &= check("count with exceptions",
+                    weekly.occurrences_between(first, first, utc(2025, 1, 1)) ==
+                    std::vector<TimePoint>{week(0), week(2), week(4)});
+    passed &= check("count with exceptions, window after the start",
+                    weekly.occurrences_between(first, week(2), utc(2025, 1, 1)) ==
+                    std::vector<TimePoint>{week(2), week(4)});
+
+    // The jump to `from` must land where walking the series would
+    TimePoint start = utc(2001, 5, 17, 9);
+    Recurrence daily = rule(Recurrence::Daily, 3);
+    TimePoint from = utc(2026, 3, 10, 0);
+    TimePoint to = utc(2026, 4, 10, 0);
+    auto jumped = daily.occurrences_between(start, from, to);
+    passed &= check("daily window far from the start matches a walk",
+                    !jumped.empty() && jumped == walk(daily, start, from, to));
+    // A window opening exactly on an occurrence includes it
+    from = start + std::chrono::hours(24 * 3 * 3000);
+    jumped = daily.occurrences_between(start, from, to);
+    passed &= check("daily window starting on an occurrence matches a walk",
+                    !jumped.empty() && jumped.front() == from && jumped == walk(daily, start, from, to));
+
+    Recurrence biweekly = rule(Recurrence::Weekly, 2, 700);
+    biweekly.exceptions = {start + std::chrono::hours(24 * 14 * 650)};
+    biweekly.until = utc(2030, 1, 1);
+    from = start + std::chrono::hours(24 * 14 * 640 + 5);
+    to = utc(2040, 1, 1);
+    jumped = biweekly.occurrences_between(start, from, to);
+    passed &= check("weekly window far from the start matches a walk, across count and exceptions",
+                    !jumped.empty() && jumped == walk(biweekly, start, from, to));
+    passed &= check("window entirely past the series is empty",
+                    biweekly.occurrences_between(start, start + std::chrono::hours(24 * 14 * 700), to).empty());
+
+    // The end of a series: by count, by until, and by an exception on the
+    // last occurrence
+    Recurrence three = rule(Recurrence::Weekly, 1, 3);
+    TimePoint next;
+    passed &= check("next_occurrence before the last returns the last",
+                    three.next_occurrence(first, week(1), next) && next == week(2));
+    passed &= check("next_occurrence after the last ends the series", !three.next_occurrence(first, week(2), next));
+
+    Recurrence until = rule(Recurrence::Weekly);
+    until.until = week(2);
+    passed &= check("next_occurrence stops at until",
+                    until.next_occurrence(first, week(1), next) && next == week(2) &&
+                    !until.next_occurrence(first, week(2), next));
+
+    three.exceptions = {week(2)};
+    passed &= check("next_occurrence with the last one excepted ends the series",
+                    !three.next_occurrence(first, week(1), next));
+
+    return passed ? 0 : 1;
+}
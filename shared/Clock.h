@@ -0,0 +1,48 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <atomic>
+#include <chrono>
+
+// Where "now" comes from for anything time-dependent (reminders, token
+// expiry). Production code uses Clock::system(); simulations and tests pass
+// a VirtualClock and move it forward themselves instead of waiting.
+class Clock {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    virtual ~Clock() {}
+    virtual time_point now() const = 0;
+
+    // The wall clock, shared process-wide
+    static const Clock& system();
+};
+
+class SystemClock : public Clock {
+public:
+    time_point now() const override { return std::chrono::system_clock::now(); }
+};
+
+inline const Clock& Clock::system() {
+    static const SystemClock clock;
+    return clock;
+}
+
+// Only moves when told to. Readable from any thread while one thread
+// drives it.
+class VirtualClock : public Clock {
+public:
+    explicit VirtualClock(time_point start = time_point()) : m_now(start.time_since_epoch().count()) {}
+
+    time_point now() const override {
+        return time_point(time_point::duration(m_now.load(std::memory_order_acquire)));
+    }
+
+    void set(time_point time) { m_now.store(time.time_since_epoch().count(), std::memory_order_release); }
+    void advance(time_point::duration by) { m_now.fetch_add(by.count(), std::memory_order_acq_rel); }
+
+private:
+    std::atomic<time_point::rep> m_now;
+};
+
+#endif // CLOCK_H
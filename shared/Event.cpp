@@ -2,64 +2,37 @@
 #include <iomanip>
 #include <sstream>
 
-Event::Event() : id(0), user_id(0), reminder_sent(false) {
+Event::Event() : id(0), user_id(0), reminder_sent(false), version(0) {
     auto now = std::chrono::system_clock::now();
     created_at = now;
     event_time = now + std::chrono::hours(1); // Default 1 hour from now
     reminder_time = event_time - std::chrono::hours(1); // 1 hour before event
 }
 
+Event::Event(Unset) : id(0), user_id(0), reminder_sent(false), version(0) {
+}
+
 Event::Event(int user_id, const std::string& title, const std::string& description, 
              const std::chrono::system_clock::time_point& event_time,
              const std::string& creator)
     : id(0), user_id(user_id), title(title), description(description), event_time(event_time),
-      creator(creator), reminder_sent(false) {
+      creator(creator), reminder_sent(false), version(0) {
     
     created_at = std::chrono::system_clock::now();
     reminder_time = event_time - std::chrono::hours(1); // Default 1 hour before
 }
 
 nlohmann::json Event::to_json() const {
-    auto event_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        event_time.time_since_epoch()).count();
-    auto reminder_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        reminder_time.time_since_epoch()).count();
-    auto created_at_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        created_at.time_since_epoch()).count();
+    return Schema::to_json(*this);
+}
 
-    return nlohmann::json{
-        {"id", id},
-        {"user_id", user_id},
-        {"title", title},
-        {"description", description},
-        {"event_time", event_time_ms},
-        {"reminder_time", reminder_time_ms},
-        {"creator", creator},
-        {"reminder_sent", reminder_sent},
-        {"created_at", created_at_ms}
-    };
+void Event::write_json(JsonWriter& writer, std::initializer_list<EventJsonMember> extra) const {
+    Schema::write_json(writer, *this, extra);
 }
 
 Event Event::from_json(const nlohmann::json& j) {
-    Event event;
-    event.id = j["id"];
-    event.user_id = j.contains("user_id") ? j["user_id"].get<int>() : 0;
-    event.title = j["title"];
-    event.description = j["description"];
-    event.creator = j["creator"];
-    event.reminder_sent = j["reminder_sent"];
-    
-    auto event_time_ms = j["event_time"].get<int64_t>();
-    auto reminder_time_ms = j["reminder_time"].get<int64_t>();
-    auto created_at_ms = j["created_at"].get<int64_t>();
-    
-    event.event_time = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(event_time_ms));
-    event.reminder_time = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(reminder_time_ms));
-    event.created_at = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(created_at_ms));
-    
+    Event event{Unset{}};
+    Schema::from_json(j, event);
     return event;
 }
 
@@ -70,13 +43,13 @@ std::string Event::get_formatted_time() const {
     return ss.str();
 }
 
-bool Event::needs_reminder() const {
+bool Event::needs_reminder(const Clock& clock) const {
     if (reminder_sent) return false;
-    auto now = std::chrono::system_clock::now();
+    auto now = clock.now();
     return now >= reminder_time && now < event_time;
 }
 
-std::chrono::minutes Event::time_until_event() const {
-    auto now = std::chrono::system_clock::now();
+std::chrono::minutes Event::time_until_event(const Clock& clock) const {
+    auto now = clock.now();
     return std::chrono::duration_cast<std::chrono::minutes>(event_time - now);
 }
\ No newline at end of file
@@ -3,7 +3,16 @@
 
 #include <string>
 #include <chrono>
+#include <initializer_list>
 #include <nlohmann/json.hpp>
+#include "Clock.h"
+#include "JsonWriter.h"
+#include "Recurrence.h"
+#include "Schema.h"
+
+// A member written into an event's JSON object next to its own fields
+// (e.g. "action" on broadcasts)
+using EventJsonMember = Schema::JsonMember;
 
 class Event {
 public:
@@ -16,6 +25,13 @@ public:
     std::string creator;
     bool reminder_sent;
     std::chrono::system_clock::time_point created_at;
+    int version;  // bumped by every client edit; 0 = unknown (skip the check)
+    Recurrence recurrence;  // event_time is the first occurrence when recurring
+
+    // Every field zero/empty and all times at the epoch; for decoders that
+    // fill the fields in anyway and shouldn't pay for reading the clock
+    struct Unset {};
+    explicit Event(Unset);
 
     Event();
     Event(int user_id, const std::string& title, const std::string& description, 
@@ -26,10 +42,36 @@ public:
     nlohmann::json to_json() const;
     static Event from_json(const nlohmann::json& j);
     
+    // Streams the same object as to_json() (plus `extra`, which must be in
+    // key order) without building it; see JsonWriter
+    void write_json(JsonWriter& writer, std::initializer_list<EventJsonMember> extra = {}) const;
+    
     // Utility functions
     std::string get_formatted_time() const;
-    bool needs_reminder() const;
-    std::chrono::minutes time_until_event() const;
+    bool needs_reminder(const Clock& clock = Clock::system()) const;
+    std::chrono::minutes time_until_event(const Clock& clock = Clock::system()) const;
 };
 
+namespace Schema {
+
+// Keys in JSON order; columns in `events` table order
+template <>
+struct Table<Event> {
+    static constexpr auto fields = std::make_tuple(
+        field("created_at", &Event::created_at, 8),
+        field("creator", &Event::creator, 6),
+        field("description", &Event::description, 3),
+        field("event_time", &Event::event_time, 4),
+        field("id", &Event::id, 0),
+        field("recurrence", &Event::recurrence, 10, Json | Optional),
+        field("reminder_sent", &Event::reminder_sent, 7),
+        field("reminder_time", &Event::reminder_time, 5),
+        field("title", &Event::title, 2),
+        field("user_id", &Event::user_id, 1, Json | Optional),
+        field("version", &Event::version, 9, Json | Optional));
+};
+static_assert(is_valid<Event>(), "Event fields must be in key order with distinct columns");
+
+} // namespace Schema
+
 #endif // EVENT_H
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "EventBatch.h"
+
+EventOperation::EventOperation() : type(Create), event_id(0) {
+}
+
+EventOperation EventOperation::create(const Event& event) {
+    EventOperation operation;
+    operation.type = Create;
+    operation.event = event;
+    return operation;
+}
+
+EventOperation EventOperation::update(const Event& event) {
+    EventOperation operation;
+    operation.type = Update;
+    operation.event = event;
+    operation.event_id = event.id;
+    return operation;
+}
+
+EventOperation EventOperation::remove(int event_id, int version) {
+    EventOperation operation;
+    operation.type = Delete;
+    operation.event_id = event_id;
+    operation.event.id = event_id;
+    operation.event.version = version;
+    return operation;
+}
+
+nlohmann::json EventOperation::to_json() const {
+    nlohmann::json j;
+    j["op"] = type_name(type);
+    if (type == Delete) {
+        j["id"] = event_id;
+        if (event.version != 0) {
+            j["version"] = event.version;
+        }
+    } else {
+        j["event"] = event.to_json();
+    }
+    return j;
+}
+
+bool EventOperation::from_json(const nlohmann::json& j, EventOperation& operation, std::string& error) {
+    if (!j.is_object() || !j.contains("op") || !j["op"].is_string()) {
+        error = "missing op";
+        return false;
+    }
+
+    const std::string& op = j["op"].get_ref<const std::string&>();
+    if (op == "delete") {
+        if (!j.contains("id") || !j["id"].is_number_integer()) {
+            error = "delete needs an integer id";
+            return false;
+        }
+        int version = j.contains("version") && j["version"].is_number_integer() ? j["version"].get<int>() : 0;
+        operation = remove(j["id"].get<int>(), version);
+        return true;
+    }
+
+    if (op != "create" && op != "update") {
+        error = "unknown op '" + op + "'";
+        return false;
+    }
+    if (!j.contains("event") || !j["event"].is_object()) {
+        error = op + " needs an event object";
+        return false;
+    }
+
+    try {
+        Event event = Event::from_json(j["event"]);
+        operation = op == "create" ? create(event) : update(event);
+    } catch (const std::exception& e) {
+        error = std::string("invalid event: ") + e.what();
+        return false;
+    }
+    return true;
+}
+
+const char* EventOperation::type_name(Type type) {
+    switch (type) {
+    case Create: return "create";
+    case Update: return "update";
+    case Delete: return "delete";
+    }
+    return "unknown";
+}
+
+namespace EventBatch {
+
+nlohmann::json to_json(const std::vector<EventOperation>& operations) {
+    nlohmann::json items = nlohmann::json::array();
+    for (const auto& operation : operations) {
+        items.push_back(operation.to_json());
+    }
+    return items;
+}
+
+} // namespace EventBatch
@@ -0,0 +1,47 @@
+#ifndef EVENT_BATCH_H
+#define EVENT_BATCH_H
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "Event.h"
+
+// One entry of an event_batch message:
+//   {"op": "create", "event": {...}}
+//   {"op": "update", "event": {...}}
+//   {"op": "delete", "id": N, "version": V}
+// Updates and deletes only apply to the caller's own events, and only if
+// the row is still at the given version (0 / absent skips that check). The
+// server broadcasts committed batches in the same shape, with the ids and
+// versions written by the batch filled in.
+class EventOperation {
+public:
+    enum Type {
+        Create,
+        Update,
+        Delete
+    };
+
+    Type type;
+    Event event;     // create / update
+    int event_id;    // target of update / delete; new id after a create commits
+
+    EventOperation();
+
+    static EventOperation create(const Event& event);
+    static EventOperation update(const Event& event);
+    static EventOperation remove(int event_id, int version = 0);
+
+    nlohmann::json to_json() const;
+
+    // Returns false with `error` set instead of throwing on malformed input
+    static bool from_json(const nlohmann::json& j, EventOperation& operation, std::string& error);
+
+    static const char* type_name(Type type);
+};
+
+namespace EventBatch {
+    nlohmann::json to_json(const std::vector<EventOperation>& operations);
+}
+
+#endif // EVENT_BATCH_H
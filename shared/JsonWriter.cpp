@@ -0,0 +1,151 @@
+#include "JsonWriter.h"
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+
+// Bytes dump() escapes (or has to validate): controls, '"', '\\' and
+// anything non-ASCII
+bool needs_attention(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\' || c >= 0x80;
+}
+
+// Length of the well-formed UTF-8 sequence at text[i], 0 if it isn't one
+// (overlong forms, surrogates and code points past U+10FFFF included, as
+// nlohmann's decoder rejects them too)
+size_t utf8_sequence_length(const unsigned char* text, size_t i, size_t length) {
+    unsigned char lead = text[i];
+    size_t size;
+    unsigned char low = 0x80, high = 0xBF;   // allowed range of the second byte
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        size = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        size = 3;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        size = 4;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+    if (i + size > length) return 0;
+    if (text[i + 1] < low || text[i + 1] > high) return 0;
+    for (size_t k = 2; k < size; ++k) {
+        if (text[i + k] < 0x80 || text[i + k] > 0xBF) return 0;
+    }
+    return size;
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(std::string& out) : m_out(out), m_need_comma(false) {
+}
+
+void JsonWriter::separate() {
+    if (m_need_comma) {
+        m_out += ',';
+    }
+    m_need_comma = true;
+}
+
+void JsonWriter::begin_object() {
+    separate();
+    m_out += '{';
+    m_need_comma = false;
+}
+
+void JsonWriter::end_object() {
+    m_out += '}';
+    m_need_comma = true;
+}
+
+void JsonWriter::begin_array() {
+    separate();
+    m_out += '[';
+    m_need_comma = false;
+}
+
+void JsonWriter::end_array() {
+    m_out += ']';
+    m_need_comma = true;
+}
+
+void JsonWriter::key(const char* name, size_t length) {
+    separate();
+    write_string(name, length);
+    m_out += ':';
+    m_need_comma = false;
+}
+
+void JsonWriter::value(const char* text, size_t length) {
+    separate();
+    write_string(text, length);
+}
+
+void JsonWriter::value(int64_t number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    m_out.append(digits, result.ptr);
+}
+
+void JsonWriter::value(bool flag) {
+    separate();
+    m_out += flag ? "true" : "false";
+}
+
+void JsonWriter::null() {
+    separate();
+    m_out += "null";
+}
+
+void JsonWriter::raw(const std::string& json) {
+    separate();
+    m_out += json;
+}
+
+// Plain runs are appended in one go; only the bytes that need escaping or
+// UTF-8 checking are looked at one by one
+void JsonWriter::write_string(const char* text, size_t length) {
+    static const char kHex[] = "0123456789abcdef";
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text);
+
+    m_out += '"';
+    size_t run = 0;
+    for (size_t i = 0; i < length;) {
+        unsigned char c = bytes[i];
+        if (!needs_attention(c)) {
+            ++i;
+            continue;
+        }
+        if (c >= 0x80) {
+            size_t size = utf8_sequence_length(bytes, i, length);
+            if (size == 0) {
+                throw std::invalid_argument("invalid UTF-8 byte at index " + std::to_string(i));
+            }
+            i += size;   // copied verbatim with the run
+            continue;
+        }
+
+        m_out.append(text + run, i - run);
+        switch (c) {
+        case '"':  m_out += "\\\""; break;
+        case '\\': m_out += "\\\\"; break;
+        case '\b': m_out += "\\b"; break;
+        case '\f': m_out += "\\f"; break;
+        case '\n': m_out += "\\n"; break;
+        case '\r': m_out += "\\r"; break;
+        case '\t': m_out += "\\t"; break;
+        default: {
+            char escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+            m_out.append(escaped, sizeof(escaped));
+            break;
+        }
+        }
+        run = ++i;
+    }
+    m_out.append(text + run, length - run);
+    m_out += '"';
+}
@@ -0,0 +1,55 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Appends JSON text straight to a string, without building a
+// nlohmann::json tree first. Output is byte-identical to nlohmann's
+// dump() for the same document: compact, strings escaped the same way,
+// and members must be written in sorted key order (nlohmann objects are
+// std::maps). Invalid UTF-8 throws std::invalid_argument where dump()
+// would throw its own type_error.
+//
+//   JsonWriter writer(out);
+//   writer.begin_object();
+//   writer.key("id");
+//   writer.value(42);
+//   writer.end_object();
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out);
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    // Member name; the next call writes its value
+    void key(const char* name, size_t length);
+    void key(const std::string& name) { key(name.data(), name.size()); }
+    void key(const char* name) { key(name, std::strlen(name)); }
+
+    void value(const char* text, size_t length);
+    void value(const std::string& text) { value(text.data(), text.size()); }
+    void value(const char* text) { value(text, std::strlen(text)); }
+    void value(int64_t number);
+    void value(int number) { value(static_cast<int64_t>(number)); }
+    void value(bool flag);
+    void null();
+
+    // Already-serialized JSON (e.g. a nlohmann dump) as the next value
+    void raw(const std::string& json);
+
+    std::string& output() { return m_out; }
+
+private:
+    void separate();
+    void write_string(const char* text, size_t length);
+
+    std::string& m_out;
+    bool m_need_comma;
+};
+
+#endif // JSON_WRITER_H
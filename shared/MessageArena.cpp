@@ -0,0 +1,35 @@
+#include "MessageArena.h"
+#include <cstddef>
+
+namespace {
+
+// Covers the decoder's scratch for any event message; bulk imports and
+// other large frames spill over to the heap and give it back on close
+constexpr size_t kArenaSize = 16 * 1024;
+
+thread_local std::pmr::memory_resource* t_current = nullptr;
+
+std::pmr::monotonic_buffer_resource& thread_arena() {
+    alignas(std::max_align_t) thread_local std::byte buffer[kArenaSize];
+    thread_local std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::new_delete_resource());
+    return arena;
+}
+
+} // namespace
+
+namespace MessageArena {
+
+std::pmr::memory_resource* current() {
+    return t_current ? t_current : std::pmr::new_delete_resource();
+}
+
+Scope::Scope() {
+    t_current = &thread_arena();
+}
+
+Scope::~Scope() {
+    t_current = nullptr;
+    thread_arena().release();
+}
+
+} // namespace MessageArena
@@ -0,0 +1,55 @@
+#ifndef MESSAGE_ARENA_H
+#define MESSAGE_ARENA_H
+
+#include <memory_resource>
+#include <string>
+
+// A per-thread std::pmr::monotonic_buffer_resource for scratch that dies
+// with the inbound message being handled. The server opens a Scope around
+// each message; everything allocated from the arena in between is dropped
+// at once when it closes, and nothing allocated there may outlive it.
+//
+// Outside a Scope (the client, tools, benchmarks) current() is the heap,
+// so the same code runs unchanged there.
+namespace MessageArena {
+
+// The calling thread's arena while a Scope is open on it, else
+// std::pmr::new_delete_resource()
+std::pmr::memory_resource* current();
+
+// Hands the thread's arena out for one message and releases it on close.
+// Scopes don't nest.
+class Scope {
+public:
+    Scope();
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+// polymorphic_allocator whose default constructor takes current() rather
+// than the process-wide default resource, for containers that
+// default-construct their allocator (nlohmann's lexer does)
+template <typename T>
+class Allocator : public std::pmr::polymorphic_allocator<T> {
+public:
+    template <typename U>
+    struct rebind {
+        using other = Allocator<U>;
+    };
+
+    Allocator() noexcept : std::pmr::polymorphic_allocator<T>(MessageArena::current()) {}
+    Allocator(std::pmr::memory_resource* resource) noexcept : std::pmr::polymorphic_allocator<T>(resource) {}
+    template <typename U>
+    Allocator(const Allocator<U>& other) noexcept : std::pmr::polymorphic_allocator<T>(other.resource()) {}
+
+    // A copy goes wherever its new owner is being built
+    Allocator select_on_container_copy_construction() const { return Allocator(); }
+};
+
+using String = std::basic_string<char, std::char_traits<char>, Allocator<char>>;
+
+} // namespace MessageArena
+
+#endif // MESSAGE_ARENA_H
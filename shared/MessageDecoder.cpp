@@ -0,0 +1,642 @@
+#include "MessageDecoder.h"
+#include "MessageArena.h"
+#include "SimdJson.h"
+#include <string_view>
+#include <tuple>
+
+namespace {
+
+using json = nlohmann::json;
+
+// Only ever driven through sax_parse: its string_t is the lexer's token
+// buffer, which then grows in the message arena instead of on the heap
+// each time a parse starts over with an empty one
+using SaxJson = nlohmann::basic_json<std::map, std::vector, MessageArena::String>;
+
+// Event members, as bits of the per-object "seen" mask
+enum EventField : unsigned {
+    FieldNone = 0,
+    FieldId = 1 << 0,
+    FieldUserId = 1 << 1,
+    FieldTitle = 1 << 2,
+    FieldDescription = 1 << 3,
+    FieldEventTime = 1 << 4,
+    FieldReminderTime = 1 << 5,
+    FieldCreator = 1 << 6,
+    FieldReminderSent = 1 << 7,
+    FieldCreatedAt = 1 << 8,
+    FieldVersion = 1 << 9,
+    FieldRecurrence = 1 << 10,
+};
+
+// A switch on the key's length rather than Schema::find_field's walk over
+// the names: this runs for every key of every event
+constexpr EventField event_field(std::string_view key) {
+    switch (key.size()) {
+    case 2:
+        return key == "id" ? FieldId : FieldNone;
+    case 5:
+        return key == "title" ? FieldTitle : FieldNone;
+    case 7:
+        if (key == "creator") return FieldCreator;
+        if (key == "user_id") return FieldUserId;
+        if (key == "version") return FieldVersion;
+        return FieldNone;
+    case 10:
+        if (key == "event_time") return FieldEventTime;
+        if (key == "created_at") return FieldCreatedAt;
+        if (key == "recurrence") return FieldRecurrence;
+        return FieldNone;
+    case 11:
+        return key == "description" ? FieldDescription : FieldNone;
+    case 13:
+        if (key == "reminder_time") return FieldReminderTime;
+        if (key == "reminder_sent") return FieldReminderSent;
+        return FieldNone;
+    default:
+        return FieldNone;
+    }
+}
+
+// Bits of the Schema::Table<Event> members whose flags include `with` and
+// exclude `without`
+constexpr unsigned schema_fields(unsigned with, unsigned without) {
+    return std::apply([&](const auto&... fields) {
+        unsigned mask = 0;
+        ((mask |= ((fields.flags & with) == with && !(fields.flags & without)) ? event_field(fields.name) : 0u), ...);
+        return mask;
+    }, Schema::Table<Event>::fields);
+}
+
+// What Event::from_json reads unconditionally
+constexpr unsigned kRequiredFields = schema_fields(Schema::Json, Schema::Optional);
+
+static_assert(schema_fields(Schema::Json, 0) == (FieldRecurrence << 1) - 1,
+              "event_field() must know every JSON member of Event, and nothing else");
+
+// Scalar member of a request's data object that isn't an event field, or
+// nullptr
+std::string* data_member(DecodedMessage& message, std::string_view key) {
+    if (key == "auth_token") return &message.auth_token;
+    if (key == "username") return &message.username;
+    if (key == "password") return &message.password;
+    if (key == "email") return &message.email;
+    if (key == "display_name") {
+        message.has_display_name = true;
+        return &message.display_name;
+    }
+    return nullptr;
+}
+
+// Integer member of a request's data object that isn't an event field, or
+// nullptr
+int64_t* data_integer(DecodedMessage& message, std::string_view key) {
+    if (key == "from") {
+        message.has_from = true;
+        return &message.from;
+    }
+    if (key == "to") {
+        message.has_to = true;
+        return &message.to;
+    }
+    return nullptr;
+}
+
+// A data object with some event members but not all that from_json
+// requires: an event_delete's id and version are kept, anything else is
+// left to the json path
+bool event_reference(DecodedMessage& message, const Event& event, unsigned seen) {
+    if (seen & ~(FieldId | FieldVersion)) return false;
+    message.id = event.id;
+    message.version = event.version;
+    message.has_id = (seen & FieldId) != 0;
+    return true;
+}
+
+std::chrono::system_clock::time_point from_ms(int64_t ms) {
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+}
+
+// nlohmann::json_sax implementation. Returning false from any callback
+// stops the parse, which is how unsupported shapes bail out early.
+class DecodeHandler {
+public:
+    explicit DecodeHandler(DecodedMessage& message) : m_message(message), m_data_event(message.take_event()) {}
+
+    ~DecodeHandler() {
+        if (!m_data_used) m_message.recycle(std::move(m_data_event));
+    }
+
+    bool null() {
+        if (top() == Envelope || top() == Skip) return true;
+        if (top() == Capture) return capture(json());
+        // Ignored in event list items, like any member from_json doesn't read
+        return top() == ListEvent && event_field(m_key) == FieldNone;
+    }
+
+    bool boolean(bool value) {
+        if (top() == Capture) return capture(value);
+        if (is_event_object()) {
+            EventField field = event_field(m_key);
+            if (field == FieldReminderSent) {
+                current_event().reminder_sent = value;
+                seen() |= field;
+                return true;
+            }
+            return field == FieldNone && top() == ListEvent;
+        }
+        return top() == Envelope || top() == Skip;
+    }
+
+    bool number_integer(int64_t value) {
+        if (top() == Capture) return capture(value);
+        if (top() == Envelope) {
+            if (m_key == "timestamp") m_message.timestamp = value;
+            return true;
+        }
+        if (is_event_object()) return event_integer(value);
+        return top() == Skip;
+    }
+
+    bool number_unsigned(uint64_t value) {
+        if (top() == Capture) return capture(value);
+        return number_integer(static_cast<int64_t>(value));
+    }
+
+    // A view: nlohmann's binary_reader passes a std::string here whatever
+    // string_t is
+    bool number_float(double value, std::string_view) {
+        if (top() == Capture) return capture(value);
+        if (is_event_object()) return event_field(m_key) == FieldNone && top() == ListEvent;
+        return top() == Envelope || top() == Skip;
+    }
+
+    bool string(SaxJson::string_t& value) {
+        switch (top()) {
+        case Envelope:
+            if (m_key == "type") m_message.type.assign(value);
+            return true;
+        case Skip:
+            return true;
+        case Capture:
+            return capture(std::string_view(value));
+        case Data:
+            if (data_string(value)) return true;
+            return event_string(value);
+        case ListEvent:
+            return event_string(value);
+        default:
+            return false;   // scalar inside an event list
+        }
+    }
+
+    bool binary(SaxJson::binary_t&) {
+        return false;
+    }
+
+    bool start_object(std::size_t) {
+        switch (top()) {
+        case Root:
+            return push(Envelope);
+        case Envelope:
+            return push(m_key == "data" ? Data : Skip);
+        case Data:
+        case ListEvent:
+            if (event_field(m_key) == FieldRecurrence) {
+                seen() |= FieldRecurrence;
+                m_capture = json::object();
+                m_capture_stack.assign(1, &m_capture);
+                return push(Capture);
+            }
+            if (top() == Data) return false;
+            return push(Skip);
+        case EventList:
+            begin_list_event();
+            return push(ListEvent);
+        case Capture:
+            m_capture_stack.push_back(capture_child(json::object()));
+            return push(Capture);
+        case Skip:
+            return push(Skip);
+        }
+        return false;
+    }
+
+    bool key(SaxJson::string_t& key) {
+        m_key.assign(key);
+        return true;
+    }
+
+    bool end_object() {
+        Context context = top();
+        --m_depth;
+        switch (context) {
+        case Envelope:
+            return !m_message.type.empty();
+        case Data:
+            // A data object with no event members is credentials or the like
+            if (m_data_seen == 0) return true;
+            if ((m_data_seen & kRequiredFields) != kRequiredFields) {
+                return event_reference(m_message, m_data_event, m_data_seen);
+            }
+            m_data_used = true;
+            m_message.events.push_back(std::move(m_data_event));
+            m_message.messages.push_back(std::move(m_data_message));
+            return true;
+        case ListEvent:
+            return (m_list_seen & kRequiredFields) == kRequiredFields;
+        case Capture:
+            return end_capture();
+        default:
+            return true;
+        }
+    }
+
+    bool start_array(std::size_t) {
+        switch (top()) {
+        case Envelope:
+            return push(m_key == "data" ? EventList : Skip);
+        case Data:
+            if (m_key != "reminders") return false;
+            return push(EventList);
+        case ListEvent:
+            return push(Skip);   // e.g. occurrences
+        case Capture:
+            m_capture_stack.push_back(capture_child(json::array()));
+            return push(Capture);
+        case Skip:
+            return push(Skip);
+        default:
+            return false;
+        }
+    }
+
+    bool end_array() {
+        Context context = top();
+        --m_depth;
+        return context == Capture ? end_capture() : true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+        return false;
+    }
+
+private:
+    enum Context {
+        Root,       // before the envelope
+        Envelope,   // {"data": ..., "timestamp": ..., "type": ...}
+        Data,       // data object: one event and/or scalar members
+        EventList,  // array of event objects
+        ListEvent,  // one event object inside an EventList
+        Capture,    // a recurrence rule, collected as a small json value
+        Skip        // a nested value nobody reads
+    };
+
+    Context top() const {
+        return m_depth == 0 ? Root : m_stack[m_depth - 1];
+    }
+
+    // False past kMaxDepth, which sends the message to the json path
+    bool push(Context context) {
+        if (m_depth == kMaxDepth) return false;
+        m_stack[m_depth++] = context;
+        return true;
+    }
+
+    bool is_event_object() const {
+        return top() == Data || top() == ListEvent;
+    }
+
+    unsigned& seen() {
+        return top() == Data ? m_data_seen : m_list_seen;
+    }
+
+    Event& current_event() {
+        return top() == Data ? m_data_event : m_message.events.back();
+    }
+
+    void begin_list_event() {
+        m_message.events.push_back(m_message.take_event());
+        m_message.messages.emplace_back();
+        m_list_seen = 0;
+    }
+
+    bool event_integer(int64_t value) {
+        EventField field = event_field(m_key);
+        Event& event = current_event();
+        switch (field) {
+        case FieldId: event.id = static_cast<int>(value); break;
+        case FieldUserId: event.user_id = static_cast<int>(value); break;
+        case FieldVersion: event.version = static_cast<int>(value); break;
+        case FieldEventTime: event.event_time = from_ms(value); break;
+        case FieldReminderTime: event.reminder_time = from_ms(value); break;
+        case FieldCreatedAt: event.created_at = from_ms(value); break;
+        case FieldNone:
+            if (top() == Data) {
+                int64_t* member = data_integer(m_message, m_key);
+                if (member) *member = value;
+                return member != nullptr;
+            }
+            return true;   // ignored in list items
+        default: return false;   // from_json would reject the type
+        }
+        seen() |= field;
+        return true;
+    }
+
+    bool event_string(std::string_view value) {
+        EventField field = event_field(m_key);
+        Event& event = current_event();
+        switch (field) {
+        case FieldTitle: event.title.assign(value); break;
+        case FieldDescription: event.description.assign(value); break;
+        case FieldCreator: event.creator.assign(value); break;
+        case FieldNone:
+            if (m_key == "message") {
+                (top() == Data ? m_data_message : m_message.messages.back()).assign(value);
+                return true;
+            }
+            if (m_key == "action") {
+                m_message.action.assign(value);
+                return true;
+            }
+            return top() == ListEvent;
+        default:
+            return false;
+        }
+        seen() |= field;
+        return true;
+    }
+
+    bool data_string(std::string_view value) {
+        std::string* member = data_member(m_message, m_key);
+        if (!member) return false;
+        member->assign(value);
+        return true;
+    }
+
+    json* capture_child(json value) {
+        json& parent = *m_capture_stack.back();
+        if (parent.is_object()) {
+            return &(parent[m_key] = std::move(value));
+        }
+        parent.push_back(std::move(value));
+        return &parent.back();
+    }
+
+    bool capture(json value) {
+        capture_child(std::move(value));
+        return true;
+    }
+
+    bool end_capture() {
+        m_capture_stack.pop_back();
+        if (!m_capture_stack.empty()) return true;
+        std::string error;
+        return Recurrence::from_json(m_capture, current_event().recurrence, error);
+    }
+
+    // Deeper than anything this decodes needs, and fixed so that decoding
+    // allocates nothing once the message's buffers have grown
+    static constexpr size_t kMaxDepth = 16;
+
+    DecodedMessage& m_message;
+    Context m_stack[kMaxDepth];
+    size_t m_depth = 0;
+    std::string m_key;
+    // EventFields set so far in the data object and in the current list item
+    unsigned m_data_seen = 0;
+    unsigned m_list_seen = 0;
+
+    Event m_data_event;
+    bool m_data_used = false;   // moved into m_message.events
+    std::string m_data_message;
+
+    json m_capture;
+    std::vector<json*> m_capture_stack;
+};
+
+#ifdef HAVE_SIMDJSON
+
+namespace ondemand = simdjson::ondemand;
+
+// DecodeHandler's rules over simdjson's on-demand API. Members nobody
+// reads are skipped without being fully validated.
+class SimdDecoder {
+public:
+    explicit SimdDecoder(DecodedMessage& message) : m_message(message) {}
+
+    bool decode(const std::string& text) {
+        ondemand::document document;
+        ondemand::object envelope;
+        if (SimdJson::iterate(text).get(document) || document.get_object().get(envelope)) return false;
+
+        for (auto member : envelope) {
+            ondemand::field field;
+            std::string_view key;
+            if (std::move(member).get(field) || field.unescaped_key().get(key)) return false;
+            ondemand::value value = field.value();
+
+            if (key == "type") {
+                std::string_view type;
+                if (value.get_string().get(type)) return false;
+                m_message.type.assign(type);
+            } else if (key == "timestamp") {
+                if (value.get_int64().get(m_message.timestamp)) return false;
+            } else if (key == "data") {
+                if (!data(value)) return false;
+            }
+        }
+        return !m_message.type.empty() && document.at_end();
+    }
+
+private:
+    bool data(ondemand::value value) {
+        ondemand::json_type type;
+        if (value.type().get(type)) return false;
+        switch (type) {
+        case ondemand::json_type::object: {
+            Event event = m_message.take_event();
+            std::string message;
+            unsigned seen = 0;
+            if (!event_object(value, event, message, seen, true)) return false;
+            if ((seen & kRequiredFields) != kRequiredFields) {
+                // Credentials or the like, or an event_delete's id
+                bool decoded = seen == 0 || event_reference(m_message, event, seen);
+                m_message.recycle(std::move(event));
+                return decoded;
+            }
+            m_message.events.push_back(std::move(event));
+            m_message.messages.push_back(std::move(message));
+            return true;
+        }
+        case ondemand::json_type::array:
+            return event_list(value);
+        case ondemand::json_type::null:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool event_list(ondemand::value value) {
+        ondemand::array array;
+        if (value.get_array().get(array)) return false;
+        for (auto element : array) {
+            ondemand::value item;
+            if (element.get(item)) return false;
+            m_message.events.push_back(m_message.take_event());
+            m_message.messages.emplace_back();
+            unsigned seen = 0;
+            if (!event_object(item, m_message.events.back(), m_message.messages.back(), seen, false)) return false;
+            if ((seen & kRequiredFields) != kRequiredFields) return false;
+        }
+        return true;
+    }
+
+    // One event object; `is_data` for the top-level data object, which may
+    // also carry credentials and reminders but nothing unknown
+    bool event_object(ondemand::value value, Event& event, std::string& message, unsigned& seen, bool is_data) {
+        ondemand::object object;
+        if (value.get_object().get(object)) return false;
+
+        for (auto member : object) {
+            ondemand::field field;
+            std::string_view key;
+            if (std::move(member).get(field) || field.unescaped_key().get(key)) return false;
+            ondemand::value item = field.value();
+
+            EventField event_member = event_field(key);
+            switch (event_member) {
+            case FieldId:
+            case FieldUserId:
+            case FieldVersion: {
+                int64_t number;
+                if (item.get_int64().get(number)) return false;
+                int& target = event_member == FieldId ? event.id
+                            : event_member == FieldUserId ? event.user_id : event.version;
+                target = static_cast<int>(number);
+                break;
+            }
+            case FieldEventTime:
+            case FieldReminderTime:
+            case FieldCreatedAt: {
+                int64_t ms;
+                if (item.get_int64().get(ms)) return false;
+                auto& target = event_member == FieldEventTime ? event.event_time
+                             : event_member == FieldReminderTime ? event.reminder_time : event.created_at;
+                target = from_ms(ms);
+                break;
+            }
+            case FieldTitle:
+            case FieldDescription:
+            case FieldCreator: {
+                std::string_view text;
+                if (item.get_string().get(text)) return false;
+                std::string& target = event_member == FieldTitle ? event.title
+                                    : event_member == FieldDescription ? event.description : event.creator;
+                target.assign(text);
+                break;
+            }
+            case FieldReminderSent:
+                if (item.get_bool().get(event.reminder_sent)) return false;
+                break;
+            case FieldRecurrence: {
+                nlohmann::json rule;
+                std::string error;
+                if (!SimdJson::to_json(item, rule) || !Recurrence::from_json(rule, event.recurrence, error)) {
+                    return false;
+                }
+                break;
+            }
+            case FieldNone: {
+                std::string* target = nullptr;
+                if (key == "message") {
+                    target = &message;
+                } else if (key == "action") {
+                    target = &m_message.action;
+                } else if (is_data) {
+                    if (int64_t* number = data_integer(m_message, key)) {
+                        if (item.get_int64().get(*number)) return false;
+                        continue;
+                    }
+                    target = data_member(m_message, key);
+                    if (!target) {
+                        if (key != "reminders") return false;
+                        if (!event_list(item)) return false;
+                        continue;
+                    }
+                } else {
+                    continue;   // ignored, as by from_json
+                }
+                std::string_view text;
+                if (item.get_string().get(text)) return false;
+                target->assign(text);
+                continue;
+            }
+            }
+            seen |= event_member;
+        }
+        return true;
+    }
+
+    DecodedMessage& m_message;
+};
+
+#endif // HAVE_SIMDJSON
+
+} // namespace
+
+// Enough for single-event messages and small reminder batches; a client
+// shouldn't hold on to a whole event_list's worth
+const size_t kMaxSpareEvents = 16;
+
+void DecodedMessage::clear() {
+    type.clear();
+    timestamp = 0;
+    for (auto& event : events) {
+        recycle(std::move(event));
+    }
+    events.clear();
+    messages.clear();
+    action.clear();
+    auth_token.clear();
+    username.clear();
+    email.clear();
+    password.clear();
+    display_name.clear();
+    has_display_name = false;
+    id = 0;
+    version = 0;
+    has_id = false;
+    from = 0;
+    to = 0;
+    has_from = false;
+    has_to = false;
+}
+
+Event DecodedMessage::take_event() {
+    if (m_spare_events.empty()) {
+        return Event(Event::Unset{});
+    }
+    Event event = std::move(m_spare_events.back());
+    m_spare_events.pop_back();
+    Schema::reset(event);
+    return event;
+}
+
+void DecodedMessage::recycle(Event&& event) {
+    if (m_spare_events.size() < kMaxSpareEvents) {
+        m_spare_events.push_back(std::move(event));
+    }
+}
+
+bool MessageDecoder::decode(const std::string& text, DecodedMessage& message) {
+    message.clear();
+#ifdef HAVE_SIMDJSON
+    return SimdDecoder(message).decode(text);
+#else
+    DecodeHandler handler(message);
+    return SaxJson::sax_parse(text, &handler);
+#endif
+}
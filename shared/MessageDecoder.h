@@ -0,0 +1,72 @@
+#ifndef MESSAGE_DECODER_H
+#define MESSAGE_DECODER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Event.h"
+
+// What MessageDecoder pulls out of a protocol message
+struct DecodedMessage {
+    std::string type;
+    int64_t timestamp = 0;
+
+    // Every event in data, in order: data itself (event_create /
+    // event_update / reminder), its elements (event_list) or
+    // data.reminders (reminder_batch). messages[i] is events[i]'s
+    // "message", empty if it has none.
+    std::vector<Event> events;
+    std::vector<std::string> messages;
+    std::string action;
+
+    // Scalar members of data
+    std::string auth_token;
+    std::string username;
+    std::string email;
+    std::string password;
+    std::string display_name;
+    bool has_display_name = false;
+
+    // data.id / data.version when data names an event without being one
+    // (event_delete)
+    int id = 0;
+    int version = 0;
+    bool has_id = false;
+
+    // data.from / data.to (event_list's window)
+    int64_t from = 0;
+    int64_t to = 0;
+    bool has_from = false;
+    bool has_to = false;
+
+    // Empties everything but keeps the buffers, including those of the
+    // first few events for the next message's to reuse
+    void clear();
+
+    // A reset Event for the decoder to fill, reusing one that clear() kept
+    // when it can; recycle() takes back one that wasn't used after all
+    Event take_event();
+    void recycle(Event&& event);
+
+private:
+    std::vector<Event> m_spare_events;
+};
+
+// One-pass decoding of protocol messages on nlohmann's SAX interface (or
+// simdjson's on-demand API in HAVE_SIMDJSON builds):
+// values go straight into Event fields and the strings above as the
+// parser reaches them, with no json DOM in between and no lookups by key
+// afterwards.
+//
+// Covers the messages that carry events, event ids or credentials.
+// Anything else (batch operations, auth_success's user object, error
+// payloads, an event missing a field Event::from_json requires, ...) makes
+// decode() return false, and the caller falls back to
+// Protocol::parse_message, which reports the problem as before.
+class MessageDecoder {
+public:
+    // Reuses `message`'s buffers; its contents are unspecified on false
+    static bool decode(const std::string& text, DecodedMessage& message);
+};
+
+#endif // MESSAGE_DECODER_H
@@ -1,4 +1,5 @@
 #include "Protocol.h"
+#include "SimdJson.h"
 #include <chrono>
 
 namespace Protocol {
@@ -12,13 +13,39 @@ nlohmann::json create_message(const std::string& type, const nlohmann::json& dat
     return message;
 }
 
+void write_message(std::string& out, const std::string& type,
+                   const std::function<void(JsonWriter& writer)>& write_data) {
+    JsonWriter writer(out);
+    writer.begin_object();
+    writer.key("data");
+    write_data(writer);
+    writer.key("timestamp");
+    writer.value(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    writer.key("type");
+    writer.value(type);
+    writer.end_object();
+}
+
 std::pair<std::string, nlohmann::json> parse_message(const std::string& message) {
-    nlohmann::json parsed = nlohmann::json::parse(message);
+    nlohmann::json parsed;
+#ifdef HAVE_SIMDJSON
+    if (!SimdJson::parse(message, parsed))
+#endif
+        parsed = nlohmann::json::parse(message);
     
     std::string type = parsed["type"];
-    nlohmann::json data = parsed.contains("data") ? parsed["data"] : nlohmann::json{};
+    nlohmann::json data = parsed.contains("data") ? std::move(parsed["data"]) : nlohmann::json{};
     
-    return {type, data};
+    return {std::move(type), std::move(data)};
+}
+
+std::string json_parser() {
+#ifdef HAVE_SIMDJSON
+    return "simdjson " + SimdJson::implementation();
+#else
+    return "nlohmann/json";
+#endif
 }
 
 } // namespace Protocol
\ No newline at end of file
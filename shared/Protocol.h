@@ -1,8 +1,10 @@
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
+#include <functional>
 #include <string>
 #include <nlohmann/json.hpp>
+#include "JsonWriter.h"
 
 namespace Protocol {
     // Event message types
@@ -10,7 +12,11 @@ namespace Protocol {
     const std::string EVENT_UPDATE = "event_update";
     const std::string EVENT_DELETE = "event_delete";
     const std::string EVENT_LIST = "event_list";
+    const std::string EVENT_BULK_IMPORT = "event_bulk_import";
+    const std::string EVENT_BATCH = "event_batch";
+    const std::string EVENT_ERROR = "event_error";
     const std::string REMINDER = "reminder";
+    const std::string REMINDER_BATCH = "reminder_batch";
     
     // Authentication message types
     const std::string AUTH_LOGIN = "auth_login";
@@ -27,8 +33,18 @@ namespace Protocol {
     // Create protocol message
     nlohmann::json create_message(const std::string& type, const nlohmann::json& data = {});
     
-    // Parse protocol message
+    // Appends create_message(type, data).dump() to out, with write_data
+    // streaming the data value instead of a json tree being built
+    void write_message(std::string& out, const std::string& type,
+                       const std::function<void(JsonWriter& writer)>& write_data);
+    
+    // Parse protocol message. Uses simdjson in HAVE_SIMDJSON builds, with
+    // nlohmann reparsing anything simdjson can't handle, so results and
+    // exceptions are the same either way.
     std::pair<std::string, nlohmann::json> parse_message(const std::string& message);
+    
+    // Which parser parse_message and MessageDecoder use, for logs
+    std::string json_parser();
 }
 
 #endif // PROTOCOL_H
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "Recurrence.h"
+#include <algorithm>
+
+namespace {
+
+const int64_t kDayMs = 24LL * 60 * 60 * 1000;
+
+int64_t to_ms(Recurrence::TimePoint time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+Recurrence::TimePoint from_ms(int64_t ms) {
+    return Recurrence::TimePoint(std::chrono::milliseconds(ms));
+}
+
+int64_t floor_div(int64_t a, int64_t b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+// Proleptic Gregorian conversions (H. Hinnant's days_from_civil /
+// civil_from_days), valid for any year we will see
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+void civil_from_days(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+unsigned days_in_month(int64_t y, unsigned m) {
+    static const unsigned kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return m == 2 && leap ? 29 : kDays[m - 1];
+}
+
+bool read_ms(const nlohmann::json& j, const char* key, Recurrence::TimePoint& out, std::string& error) {
+    if (!j.contains(key)) return true;
+    if (!j[key].is_number_integer()) {
+        error = std::string("recurrence ") + key + " must be a millisecond timestamp";
+        return false;
+    }
+    out = from_ms(j[key].get<int64_t>());
+    return true;
+}
+
+} // namespace
+
+Recurrence::Recurrence() : frequency(None), interval(1), count(0) {
+}
+
+bool Recurrence::candidate(TimePoint first, long index, TimePoint& start) const {
+    int64_t first_ms = to_ms(first);
+    switch (frequency) {
+    case Daily:
+        start = from_ms(first_ms + index * interval * kDayMs);
+        return true;
+    case Weekly:
+        start = from_ms(first_ms + index * interval * 7 * kDayMs);
+        return true;
+    case Monthly: {
+        int64_t days = floor_div(first_ms, kDayMs);
+        int64_t time_of_day = first_ms - days * kDayMs;
+        int64_t y;
+        unsigned m, d;
+        civil_from_days(days, y, m, d);
+
+        int64_t months = static_cast<int64_t>(m - 1) + static_cast<int64_t>(index) * interval;
+        int64_t year = y + floor_div(months, 12);
+        unsigned month = static_cast<unsigned>(months - floor_div(months, 12) * 12) + 1;
+        if (d > days_in_month(year, month)) {
+            return false;
+        }
+        start = from_ms(days_from_civil(year, month, d) * kDayMs + time_of_day);
+        return true;
+    }
+    case None:
+        break;
+    }
+    start = first;
+    return index == 0;
+}
+
+bool Recurrence::is_exception(TimePoint start) const {
+    return std::binary_search(exceptions.begin(), exceptions.end(), start);
+}
+
+std::vector<Recurrence::TimePoint> Recurrence::occurrences_between(TimePoint first, TimePoint from, TimePoint to,
+                                                                   size_t limit) const {
+    std::vector<TimePoint> starts;
+    if (!is_recurring()) {
+        if (first >= from && first < to && limit > 0) {
+            starts.push_back(first);
+        }
+        return starts;
+    }
+
+    // Jump close to `from` instead of walking the series from its start.
+    // A count has to see every earlier occurrence, except where none can
+    // be skipped (daily / weekly, or monthly on a day every month has).
+    long index = 0;
+    int64_t first_ms = to_ms(first);
+    int64_t from_ms_value = to_ms(from);
+    if (from_ms_value > first_ms) {
+        int64_t first_days = floor_div(first_ms, kDayMs);
+        int64_t y;
+        unsigned m, d;
+        civil_from_days(first_days, y, m, d);
+
+        if (frequency == Daily || frequency == Weekly) {
+            int64_t step = interval * (frequency == Weekly ? 7 : 1) * kDayMs;
+            index = static_cast<long>((from_ms_value - first_ms) / step);
+        } else if (count == 0 || d <= 28) {
+            int64_t from_y;
+            unsigned from_m, from_d;
+            civil_from_days(floor_div(from_ms_value, kDayMs), from_y, from_m, from_d);
+            int64_t months = (from_y - y) * 12 + (static_cast<int64_t>(from_m) - static_cast<int64_t>(m));
+            index = static_cast<long>(std::max<int64_t>(0, months / interval - 1));
+        }
+    }
+
+    // Candidates before `index` are all valid occurrences in the jump cases
+    long produced = index;
+    for (;; ++index) {
+        TimePoint start;
+        if (!candidate(first, index, start)) {
+            continue;
+        }
+        if (count > 0 && produced >= count) break;
+        ++produced;
+
+        if (until != TimePoint() && start > until) break;
+        if (start >= to) break;
+        if (start >= from && !is_exception(start)) {
+            starts.push_back(start);
+            if (starts.size() >= limit) break;
+        }
+    }
+    return starts;
+}
+
+bool Recurrence::next_occurrence(TimePoint first, TimePoint after, TimePoint& start) const {
+    auto next = occurrences_between(first, after + std::chrono::milliseconds(1), TimePoint::max(), 1);
+    if (next.empty()) {
+        return false;
+    }
+    start = next.front();
+    return true;
+}
+
+nlohmann::json Recurrence::to_json() const {
+    nlohmann::json j = nlohmann::json::object();
+    if (!is_recurring()) {
+        return j;
+    }
+
+    j["freq"] = frequency_name(frequency);
+    if (interval != 1) j["interval"] = interval;
+    if (count != 0) j["count"] = count;
+    if (until != TimePoint()) j["until"] = to_ms(until);
+    if (!exceptions.empty()) {
+        nlohmann::json skipped = nlohmann::json::array();
+        for (const auto& start : exceptions) {
+            skipped.push_back(to_ms(start));
+        }
+        j["exceptions"] = std::move(skipped);
+    }
+    if (last_reminded != TimePoint()) j["last_reminded"] = to_ms(last_reminded);
+    return j;
+}
+
+// Same members as to_json(), in its (sorted) key order
+void Recurrence::write_json(JsonWriter& writer) const {
+    writer.begin_object();
+    if (is_recurring()) {
+        if (count != 0) {
+            writer.key("count");
+            writer.value(count);
+        }
+        if (!exceptions.empty()) {
+            writer.key("exceptions");
+            writer.begin_array();
+            for (const auto& start : exceptions) {
+                writer.value(to_ms(start));
+            }
+            writer.end_array();
+        }
+        writer.key("freq");
+        writer.value(frequency_name(frequency));
+        if (interval != 1) {
+            writer.key("interval");
+            writer.value(interval);
+        }
+        if (last_reminded != TimePoint()) {
+            writer.key("last_reminded");
+            writer.value(to_ms(last_reminded));
+        }
+        if (until != TimePoint()) {
+            writer.key("until");
+            writer.value(to_ms(until));
+        }
+    }
+    writer.end_object();
+}
+
+bool Recurrence::from_json(const nlohmann::json& j, Recurrence& recurrence, std::string& error) {
+    recurrence = Recurrence();
+    if (j.is_null()) {
+        return true;
+    }
+    if (!j.is_object()) {
+        error = "recurrence must be an object";
+        return false;
+    }
+    if (j.empty()) {
+        return true;
+    }
+
+    std::string freq = j.contains("freq") && j["freq"].is_string() ? j["freq"].get<std::string>() : "";
+    if (freq == "none") {
+        return true;
+    } else if (freq == "daily") {
+        recurrence.frequency = Daily;
+    } else if (freq == "weekly") {
+        recurrence.frequency = Weekly;
+    } else if (freq == "monthly") {
+        recurrence.frequency = Monthly;
+    } else {
+        error = "recurrence freq must be daily, weekly or monthly";
+        return false;
+    }
+
+    if (j.contains("interval")) {
+        if (!j["interval"].is_number_integer() || j["interval"].get<int>() < 1 || j["interval"].get<int>() > 1000) {
+            error = "recurrence interval must be an integer from 1 to 1000";
+            return false;
+        }
+        recurrence.interval = j["interval"].get<int>();
+    }
+    if (j.contains("count")) {
+        if (!j["count"].is_number_integer() || j["count"].get<int>() < 0) {
+            error = "recurrence count must be a non-negative integer";
+            return false;
+        }
+        recurrence.count = j["count"].get<int>();
+    }
+    if (!read_ms(j, "until", recurrence.until, error) ||
+        !read_ms(j, "last_reminded", recurrence.last_reminded, error)) {
+        return false;
+    }
+    if (j.contains("exceptions")) {
+        if (!j["exceptions"].is_array()) {
+            error = "recurrence exceptions must be an array of timestamps";
+            return false;
+        }
+        for (const auto& skipped : j["exceptions"]) {
+            if (!skipped.is_number_integer()) {
+                error = "recurrence exceptions must be an array of timestamps";
+                return false;
+            }
+            recurrence.exceptions.push_back(from_ms(skipped.get<int64_t>()));
+        }
+        std::sort(recurrence.exceptions.begin(), recurrence.exceptions.end());
+    }
+    return true;
+}
+
+const char* Recurrence::frequency_name(Frequency frequency) {
+    switch (frequency) {
+    case Daily: return "daily";
+    case Weekly: return "weekly";
+    case Monthly: return "monthly";
+    case None: break;
+    }
+    return "none";
+}
+
+bool Recurrence::operator==(const Recurrence& other) const {
+    return frequency == other.frequency && interval == other.interval && count == other.count &&
+           until == other.until && exceptions == other.exceptions && last_reminded == other.last_reminded;
+}
@@ -0,0 +1,91 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "JsonWriter.h"
+#include "Schema.h"
+
+// Repeat rule of an event, stored once with it. The event's event_time is
+// the first occurrence; every occurrence keeps the same reminder lead
+// (event_time - reminder_time). Occurrences are never stored: callers ask
+// for the ones inside a window, or for the next one, and only those are
+// computed. Calendar math is UTC.
+//
+//   {"freq": "weekly", "interval": 1, "count": 10, "until": ms,
+//    "exceptions": [ms, ...], "last_reminded": ms}
+//
+// count includes the first occurrence and is applied before exceptions
+// (as RRULE COUNT / EXDATE). A monthly rule on the 31st skips shorter
+// months. last_reminded is server state: the start of the latest
+// occurrence whose reminder went out.
+class Recurrence {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    enum Frequency {
+        None,
+        Daily,
+        Weekly,
+        Monthly
+    };
+
+    Frequency frequency;
+    int interval;                       // every N days / weeks / months, >= 1
+    int count;                          // 0 = unlimited
+    TimePoint until;                    // last allowed start; epoch = unlimited
+    std::vector<TimePoint> exceptions;  // skipped occurrence starts, sorted
+    TimePoint last_reminded;            // epoch = none yet
+
+    Recurrence();
+
+    bool is_recurring() const { return frequency != None; }
+
+    // Occurrence starts in [from, to), earliest first, at most `limit`
+    std::vector<TimePoint> occurrences_between(TimePoint first, TimePoint from, TimePoint to,
+                                               size_t limit = 1000) const;
+
+    // First occurrence start strictly after `after`; false once the series ends
+    bool next_occurrence(TimePoint first, TimePoint after, TimePoint& start) const;
+
+    // Omits the defaults; an empty object for a non-recurring rule
+    nlohmann::json to_json() const;
+    void write_json(JsonWriter& writer) const;
+
+    // Returns false with `error` set instead of throwing on malformed input
+    static bool from_json(const nlohmann::json& j, Recurrence& recurrence, std::string& error);
+
+    static const char* frequency_name(Frequency frequency);
+
+    bool operator==(const Recurrence& other) const;
+    bool operator!=(const Recurrence& other) const { return !(*this == other); }
+
+private:
+    // Start of candidate `index` (before count / until / exceptions);
+    // false for a month that lacks the first occurrence's day
+    bool candidate(TimePoint first, long index, TimePoint& start) const;
+    bool is_exception(TimePoint start) const;
+};
+
+namespace Schema {
+
+// Only recurring rules are written, so single events keep their old shape
+template <>
+struct Codec<Recurrence> {
+    static bool present(const Recurrence& value) { return value.is_recurring(); }
+    static nlohmann::json to_json(const Recurrence& value) { return value.to_json(); }
+    static void from_json(const nlohmann::json& j, Recurrence& value) {
+        std::string error;
+        if (!Recurrence::from_json(j, value, error)) {
+            throw std::invalid_argument(error);
+        }
+    }
+    static void write(JsonWriter& writer, const Recurrence& value) { value.write_json(writer); }
+};
+
+} // namespace Schema
+
+#endif // RECURRENCE_H
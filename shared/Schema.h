@@ -0,0 +1,230 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <nlohmann/json.hpp>
+#include "JsonWriter.h"
+
+// Compile-time field tables for the classes that go over the wire and into
+// the database. A class specializes Schema::Table<T> with one entry per
+// member, in JSON key order:
+//
+//   template <> struct Schema::Table<Event> {
+//       static constexpr auto fields = std::make_tuple(
+//           Schema::field("created_at", &Event::created_at, 8), ...);
+//   };
+//
+// The JSON key doubles as the column name, and the column index is the
+// member's position in SELECT * (-1 if it isn't stored). Everything that
+// walks the members -- to_json / from_json / write_json here, the row
+// binder and reader in the server's RowCodec.h, MessageDecoder -- is
+// generated from the table: member pointers and column indices are
+// constants, and nothing looks a name up except when decoding JSON keys.
+//
+// Member types are handled by Codec<Member>; Recurrence's lives next to it.
+namespace Schema {
+
+using TimePoint = std::chrono::system_clock::time_point;
+
+enum Flags : unsigned {
+    Json = 1 << 0,      // part of the JSON form (password_hash isn't)
+    Optional = 1 << 1,  // from_json keeps the member's value when the key is missing
+};
+
+template <class Object, class Member>
+struct Field {
+    using Type = Member;
+
+    std::string_view name;
+    Member Object::*member;
+    int column;
+    unsigned flags;
+};
+
+template <class Object, class Member>
+constexpr Field<Object, Member> field(std::string_view name, Member Object::*member, int column,
+                                      unsigned flags = Json) {
+    return {name, member, column, flags};
+}
+
+template <class T>
+struct Table;
+
+template <class T>
+constexpr size_t field_count() {
+    return std::tuple_size<decltype(Table<T>::fields)>::value;
+}
+
+template <class T, class F>
+void for_each_field(F&& f) {
+    std::apply([&](const auto&... fields) { (f(fields), ...); }, Table<T>::fields);
+}
+
+// f(field) for the field at `index` in the table; false if there is none
+template <class T, class F>
+bool visit_field(size_t index, F&& f) {
+    bool result = false;
+    size_t i = 0;
+    for_each_field<T>([&](const auto& field) {
+        if (i++ == index) result = f(field);
+    });
+    return result;
+}
+
+// Table index of the JSON member `key`, -1 if T has none
+template <class T>
+int find_field(std::string_view key) {
+    int found = -1;
+    int i = 0;
+    for_each_field<T>([&](const auto& field) {
+        if (found < 0 && (field.flags & Json) && field.name == key) found = i;
+        ++i;
+    });
+    return found;
+}
+
+// Bit i set for each table index i that from_json requires
+template <class T>
+constexpr unsigned required_fields() {
+    return std::apply([](const auto&... fields) {
+        unsigned mask = 0, bit = 1;
+        ((mask |= ((fields.flags & Json) && !(fields.flags & Optional)) ? bit : 0u, bit <<= 1), ...);
+        return mask;
+    }, Table<T>::fields);
+}
+
+// Keys strictly ascending (write_json relies on it) and no column used twice
+template <class T>
+constexpr bool is_valid() {
+    constexpr size_t n = field_count<T>();
+    auto names = std::apply([](const auto&... fields) {
+        return std::array<std::string_view, n>{fields.name...};
+    }, Table<T>::fields);
+    auto columns = std::apply([](const auto&... fields) {
+        return std::array<int, n>{fields.column...};
+    }, Table<T>::fields);
+    for (size_t i = 0; i < n; ++i) {
+        if (i > 0 && !(names[i - 1] < names[i])) return false;
+        for (size_t k = i + 1; k < n; ++k) {
+            if (columns[i] >= 0 && columns[i] == columns[k]) return false;
+        }
+    }
+    return n <= 32;   // required_fields() is a 32-bit mask
+}
+
+// Every member back to its value-initialized state (what Event::Unset
+// gives), with strings cleared in place so a reused object keeps their
+// buffers
+template <class T>
+void reset(T& object) {
+    for_each_field<T>([&](const auto& field) {
+        using Member = typename std::decay_t<decltype(field)>::Type;
+        Member& value = object.*field.member;
+        if constexpr (std::is_same_v<Member, std::string>) {
+            value.clear();
+        } else {
+            value = Member{};
+        }
+    });
+}
+
+// JSON form of a member type. present() false leaves the key out.
+template <class Member>
+struct Codec {
+    static bool present(const Member&) { return true; }
+    static nlohmann::json to_json(const Member& value) { return value; }
+    static void from_json(const nlohmann::json& j, Member& value) { j.get_to(value); }
+    static void write(JsonWriter& writer, const Member& value) { writer.value(value); }
+};
+
+// Milliseconds since the epoch
+template <>
+struct Codec<TimePoint> {
+    static int64_t ms(TimePoint time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    }
+    static TimePoint from_ms(int64_t ms) { return TimePoint(std::chrono::milliseconds(ms)); }
+
+    static bool present(TimePoint) { return true; }
+    static nlohmann::json to_json(TimePoint value) { return ms(value); }
+    static void from_json(const nlohmann::json& j, TimePoint& value) { value = from_ms(j.get<int64_t>()); }
+    static void write(JsonWriter& writer, TimePoint value) { writer.value(ms(value)); }
+};
+
+template <class T>
+nlohmann::json to_json(const T& object) {
+    nlohmann::json j = nlohmann::json::object();
+    for_each_field<T>([&](const auto& field) {
+        using Member = typename std::decay_t<decltype(field)>::Type;
+        const Member& value = object.*field.member;
+        if ((field.flags & Json) && Codec<Member>::present(value)) {
+            j[std::string(field.name)] = Codec<Member>::to_json(value);
+        }
+    });
+    return j;
+}
+
+// Throws nlohmann's out_of_range for a missing required key and its
+// type_error for a mistyped one
+template <class T>
+void from_json(const nlohmann::json& j, T& object) {
+    for_each_field<T>([&](const auto& field) {
+        using Member = typename std::decay_t<decltype(field)>::Type;
+        if (!(field.flags & Json)) return;
+        auto it = j.find(field.name);
+        if (it == j.end()) {
+            if (!(field.flags & Optional)) {
+                j.at(std::string(field.name));   // throws
+            }
+            return;
+        }
+        Codec<Member>::from_json(*it, object.*field.member);
+    });
+}
+
+// A member written next to an object's own fields (e.g. "action" on
+// broadcasts)
+struct JsonMember {
+    const char* key;
+    std::function<void(JsonWriter& writer)> write;
+};
+
+// Streams the same object to_json() builds, with `extra` (in key order)
+// merged in where nlohmann's std::map would put it
+template <class T>
+void write_json(JsonWriter& writer, const T& object, std::initializer_list<JsonMember> extra = {}) {
+    auto next = extra.begin();
+    auto flush_before = [&](std::string_view key) {
+        for (; next != extra.end() && std::string_view(next->key) < key; ++next) {
+            writer.key(next->key);
+            next->write(writer);
+        }
+    };
+
+    writer.begin_object();
+    for_each_field<T>([&](const auto& field) {
+        using Member = typename std::decay_t<decltype(field)>::Type;
+        const Member& value = object.*field.member;
+        if (!(field.flags & Json) || !Codec<Member>::present(value)) return;
+        flush_before(field.name);
+        writer.key(field.name.data(), field.name.size());
+        Codec<Member>::write(writer, value);
+    });
+    for (; next != extra.end(); ++next) {
+        writer.key(next->key);
+        next->write(writer);
+    }
+    writer.end_object();
+}
+
+} // namespace Schema
+
+#endif // SCHEMA_H
@@ -0,0 +1,113 @@
+#include "SimdJson.h"
+
+#ifdef HAVE_SIMDJSON
+
+namespace ondemand = simdjson::ondemand;
+
+namespace SimdJson {
+
+simdjson::simdjson_result<ondemand::document> iterate(const std::string& text) {
+    thread_local ondemand::parser parser;
+    thread_local std::string padded;
+    
+    if (text.capacity() - text.size() >= simdjson::SIMDJSON_PADDING) {
+        return parser.iterate(text);
+    }
+    padded.reserve(text.size() + simdjson::SIMDJSON_PADDING);
+    padded.assign(text);
+    return parser.iterate(padded);
+}
+
+bool to_json(ondemand::value value, nlohmann::json& out) {
+    ondemand::json_type type;
+    if (value.type().get(type)) return false;
+    
+    switch (type) {
+    case ondemand::json_type::object: {
+        ondemand::object object;
+        if (value.get_object().get(object)) return false;
+        out = nlohmann::json::object();
+        for (auto member : object) {
+            ondemand::field field;
+            std::string_view key;
+            if (std::move(member).get(field) || field.unescaped_key().get(key)) return false;
+            // Later duplicates replace earlier ones, as in json::parse
+            if (!to_json(field.value(), out[std::string(key)])) return false;
+        }
+        return true;
+    }
+    case ondemand::json_type::array: {
+        ondemand::array array;
+        if (value.get_array().get(array)) return false;
+        out = nlohmann::json::array();
+        for (auto element : array) {
+            ondemand::value item;
+            if (element.get(item)) return false;
+            out.push_back(nullptr);
+            if (!to_json(item, out.back())) return false;
+        }
+        return true;
+    }
+    case ondemand::json_type::string: {
+        std::string_view text;
+        if (value.get_string().get(text)) return false;
+        out = std::string(text);
+        return true;
+    }
+    case ondemand::json_type::number: {
+        ondemand::number_type number_type;
+        if (value.get_number_type().get(number_type)) return false;
+        if (number_type == ondemand::number_type::floating_point_number) {
+            double number;
+            if (value.get_double().get(number)) return false;
+            out = number;
+        } else if (number_type == ondemand::number_type::signed_integer) {
+            int64_t number;
+            if (value.get_int64().get(number)) return false;
+            // json::parse stores non-negative integers as unsigned
+            if (number >= 0) {
+                out = static_cast<uint64_t>(number);
+            } else {
+                out = number;
+            }
+        } else if (number_type == ondemand::number_type::unsigned_integer) {
+            uint64_t number;
+            if (value.get_uint64().get(number)) return false;
+            out = number;
+        } else {
+            return false;   // big_integer
+        }
+        return true;
+    }
+    case ondemand::json_type::boolean: {
+        bool flag;
+        if (value.get_bool().get(flag)) return false;
+        out = flag;
+        return true;
+    }
+    case ondemand::json_type::null: {
+        bool is_null;
+        if (value.is_null().get(is_null) || !is_null) return false;
+        out = nullptr;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool parse(const std::string& text, nlohmann::json& out) {
+    ondemand::document document;
+    ondemand::value root;
+    if (iterate(text).get(document) || document.get_value().get(root)) return false;
+    return to_json(root, out) && document.at_end();
+}
+
+std::string implementation() {
+    const auto& active = simdjson::get_active_implementation();
+    return active->name() + " (" + active->description() + ")";
+}
+
+} // namespace SimdJson
+
+#endif // HAVE_SIMDJSON
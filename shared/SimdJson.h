@@ -0,0 +1,35 @@
+#ifndef SIMD_JSON_H
+#define SIMD_JSON_H
+
+// simdjson glue for builds configured with USE_SIMDJSON (which defines
+// HAVE_SIMDJSON when the library is found). simdjson picks its kernel
+// (haswell/AVX2, westmere/SSE4.2, ..., fallback) for the CPU at runtime;
+// SIMDJSON_FORCE_IMPLEMENTATION=<name> in the environment overrides it.
+
+#ifdef HAVE_SIMDJSON
+
+#include <string>
+#include <nlohmann/json.hpp>
+#include <simdjson.h>
+
+namespace SimdJson {
+    // Starts this thread's on-demand parser on `text`, copying it into a
+    // padded buffer first unless its spare capacity already covers
+    // SIMDJSON_PADDING. The document is valid until the next call on the
+    // same thread.
+    simdjson::simdjson_result<simdjson::ondemand::document> iterate(const std::string& text);
+    
+    // The nlohmann tree json::parse would build for `value`; false if
+    // simdjson can't produce exactly that (e.g. integers beyond 64 bits)
+    bool to_json(simdjson::ondemand::value value, nlohmann::json& out);
+    
+    // to_json over a whole document; false on any error or trailing content
+    bool parse(const std::string& text, nlohmann::json& out);
+    
+    // Kernel simdjson chose for this CPU
+    std::string implementation();
+}
+
+#endif // HAVE_SIMDJSON
+
+#endif // SIMD_JSON_H
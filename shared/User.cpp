@@ -20,39 +20,12 @@ User::User(const std::string& username, const std::string& email,
 }
 
 nlohmann::json User::to_json() const {
-    auto created_at_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        created_at.time_since_epoch()).count();
-    auto last_login_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        last_login.time_since_epoch()).count();
-
-    return nlohmann::json{
-        {"id", id},
-        {"username", username},
-        {"email", email},
-        {"display_name", display_name},
-        {"created_at", created_at_ms},
-        {"last_login", last_login_ms},
-        {"is_active", is_active}
-        // Note: password_hash is NOT included for security
-    };
+    return Schema::to_json(*this);   // password_hash has no Json flag
 }
 
 User User::from_json(const nlohmann::json& j) {
     User user;
-    user.id = j["id"];
-    user.username = j["username"];
-    user.email = j["email"];
-    user.display_name = j["display_name"];
-    user.is_active = j["is_active"];
-    
-    auto created_at_ms = j["created_at"].get<int64_t>();
-    auto last_login_ms = j["last_login"].get<int64_t>();
-    
-    user.created_at = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(created_at_ms));
-    user.last_login = std::chrono::system_clock::time_point(
-        std::chrono::milliseconds(last_login_ms));
-    
+    Schema::from_json(j, user);
     return user;
 }
 
@@ -143,8 +116,8 @@ bool User::is_valid_password(const std::string& password) {
 }
 
 // AuthToken implementation
-bool AuthToken::is_valid() const {
-    return std::chrono::system_clock::now() < expires_at;
+bool AuthToken::is_valid(const Clock& clock) const {
+    return clock.now() < expires_at;
 }
 
 nlohmann::json AuthToken::to_json() const {
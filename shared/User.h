@@ -4,6 +4,8 @@
 #include <string>
 #include <chrono>
 #include <nlohmann/json.hpp>
+#include "Clock.h"
+#include "Schema.h"
 // Add this include at the top of shared/User.h
 #include <openssl/sha.h>
 
@@ -42,9 +44,29 @@ struct AuthToken {
     int user_id;
     std::chrono::system_clock::time_point expires_at;
     
-    bool is_valid() const;
+    bool is_valid(const Clock& clock = Clock::system()) const;
     nlohmann::json to_json() const;
     static AuthToken from_json(const nlohmann::json& j);
 };
 
+namespace Schema {
+
+// Keys in JSON order; columns in `users` table order. The password hash
+// is stored but never serialized.
+template <>
+struct Table<User> {
+    static constexpr auto fields = std::make_tuple(
+        field("created_at", &User::created_at, 5),
+        field("display_name", &User::display_name, 4),
+        field("email", &User::email, 2),
+        field("id", &User::id, 0),
+        field("is_active", &User::is_active, 7),
+        field("last_login", &User::last_login, 6),
+        field("password_hash", &User::password_hash, 3, 0),
+        field("username", &User::username, 1));
+};
+static_assert(is_valid<User>(), "User fields must be in key order with distinct columns");
+
+} // namespace Schema
+
 #endif // USER_H
\ No newline at end of file